@@ -0,0 +1,147 @@
+#include <ftxui/dom/elements.hpp>
+#include <ftxui/screen/screen.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../src/api/slurmjobs.hpp"
+#include "../src/components/nodedetails.hpp"
+#include "../src/components/prompts/partitions.hpp"
+
+#include "fixtures.hpp"
+
+using namespace ftxui;
+
+struct Result {
+    std::string name;
+    size_t iterations = 0;
+    double mean_us = 0;
+    double p50_us = 0;
+    double min_us = 0;
+    double max_us = 0;
+};
+
+// Repeats `fn` until both `min_iterations` and `min_seconds` are reached.
+static Result run(const std::string& name, const std::function<void()>& fn,
+                  size_t min_iterations = 5, double min_seconds = 0.5) {
+    using clock = std::chrono::steady_clock;
+
+    fn(); // warm-up, fills static regexes
+
+    std::vector<double> samples;
+    auto begin = clock::now();
+    while (samples.size() < min_iterations ||
+           std::chrono::duration<double>(clock::now() - begin).count() < min_seconds) {
+        // measure the parsers, not the single-flight cache in front of them
+        api::slurm::invalidateCaches();
+
+        auto start = clock::now();
+        fn();
+        samples.push_back(std::chrono::duration<double, std::micro>(clock::now() - start).count());
+    }
+
+    std::sort(samples.begin(), samples.end());
+
+    Result r;
+    r.name = name;
+    r.iterations = samples.size();
+    for (double s : samples) r.mean_us += s;
+    r.mean_us /= samples.size();
+    r.p50_us = samples[samples.size() / 2];
+    r.min_us = samples.front();
+    r.max_us = samples.back();
+    return r;
+}
+
+// Makes `value` escape, so the compiler cannot drop the work behind it.
+template <typename T>
+static void keep(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+static void renderOffscreen(Element element, int width) {
+    auto screen = Screen::Create(Dimension::Fixed(width), Dimension::Fit(element));
+    Render(screen, element);
+    keep(screen.dimy());
+}
+
+int main(int argc, char** argv) {
+    bool json = false;
+    std::string filter;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--json") {
+            json = true;
+        } else if (arg == "--filter" && i + 1 < argc) {
+            filter = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--json] [--filter <substring>]\n";
+            return 1;
+        }
+    }
+
+    fixtures::Cluster cluster;
+    for (int nodes : {1, 100, 2000}) cluster.addJob(nodes);
+    cluster.outputs["scontrol show node " + fixtures::hostlist(0, 10000)] = fixtures::showNodes(0, 10000);
+    cluster.outputs["scontrol show node -o"] = fixtures::showNodesOneLine(10000);
+    cluster.outputs["sinfo"] = fixtures::sinfo(200);
+    cluster.outputs["sacct"] = fixtures::sacct(100000);
+
+    api::slurm::setRunner(std::ref(cluster));
+
+    std::vector<std::pair<std::string, std::function<void()>>> cases;
+
+    std::string cpu_ids;
+    for (int i = 0; i < 256; i += 4) cpu_ids += (cpu_ids.empty() ? "" : ",") + std::to_string(i) + "-" + std::to_string(i + 1);
+    cases.push_back({"parseCpuIds/64_ranges", [&] { keep(api::slurm::parseCpuIds(cpu_ids)); }});
+
+    for (int nodes : {1, 100, 2000}) {
+        cases.push_back({"getJobDetails/" + std::to_string(nodes) + "_nodes",
+                         [nodes] { keep(api::slurm::getJobDetails(std::to_string(nodes))); }});
+    }
+
+    std::string all_nodes = fixtures::hostlist(0, 10000);
+    cases.push_back({"getAllNodeInfo/10000_nodes", [&] { keep(api::slurm::getAllNodeInfo(all_nodes)); }});
+    cases.push_back({"getClusterNodes/10000_nodes", [] { keep(api::slurm::getClusterNodes()); }});
+    cases.push_back({"getPartitions/200_partitions", [] { keep(api::slurm::getPartitions()); }});
+    cases.push_back({"getJobHistory/100000_rows", [] { keep(api::slurm::getJobHistory()); }});
+
+    for (int nodes : {1, 100, 2000}) {
+        auto job = std::make_shared<api::DetailedJob>(api::slurm::getJobDetails(std::to_string(nodes)));
+        cases.push_back({"render/nodedetails/" + std::to_string(nodes) + "_nodes",
+                         [job] { renderOffscreen(ui::nodedetails(*job, 200)->Render(), 200); }});
+    }
+    auto partitions = std::make_shared<std::vector<api::PartitionInfo>>(api::slurm::getPartitions());
+    auto waits = std::make_shared<api::QueueWaits>();
+    cases.push_back({"render/paritionsModal/200_partitions",
+                     [partitions, waits] { renderOffscreen(ui::paritionsModal(partitions, waits, nullptr, false)->Render(), 140); }});
+
+    std::vector<Result> results;
+    for (const auto& [name, fn] : cases) {
+        if (!filter.empty() && name.find(filter) == std::string::npos) continue;
+        results.push_back(run(name, fn));
+        if (!json) {
+            const auto& r = results.back();
+            std::printf("%-40s %8zu iters  mean %12.1f us  p50 %12.1f us  min %12.1f us\n",
+                        r.name.c_str(), r.iterations, r.mean_us, r.p50_us, r.min_us);
+        }
+    }
+
+    if (json) {
+        std::printf("[\n");
+        for (size_t i = 0; i < results.size(); ++i) {
+            const auto& r = results[i];
+            std::printf("  {\"name\": \"%s\", \"iterations\": %zu, \"mean_us\": %.3f, \"p50_us\": %.3f, \"min_us\": %.3f, \"max_us\": %.3f}%s\n",
+                        r.name.c_str(), r.iterations, r.mean_us, r.p50_us, r.min_us, r.max_us,
+                        i + 1 < results.size() ? "," : "");
+        }
+        std::printf("]\n");
+    }
+
+    return 0;
+}
@@ -0,0 +1,192 @@
+#pragma once
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+// Deterministic stand-ins for captured Slurm output. Layouts follow what
+// scontrol/sinfo/sacct print on ROMEO so the parsers walk the same shapes
+// as in production, only scaled up.
+namespace fixtures {
+
+inline std::string nodeName(int i) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "romeo-a%04d", i);
+    return buf;
+}
+
+// "romeo-a[0001-0010]" for the range [from, to).
+inline std::string hostlist(int from, int to) {
+    char buf[64];
+    if (to - from == 1) return nodeName(from);
+    std::snprintf(buf, sizeof(buf), "romeo-a[%04d-%04d]", from, to - 1);
+    return buf;
+}
+
+// Multi-line `scontrol show node` record.
+inline std::string nodeRecord(int i) {
+    int alloc = (i * 37) % 129;
+    std::string name = nodeName(i);
+    std::string state = alloc == 0 ? "IDLE" : alloc == 128 ? "ALLOCATED" : "MIXED";
+
+    return "NodeName=" + name + " Arch=x86_64 CoresPerSocket=64\n"
+           "   CPUAlloc=" + std::to_string(alloc) + " CPUEfctv=128 CPUTot=128 CPULoad=" + std::to_string(alloc / 2) + ".00\n"
+           "   AvailableFeatures=x86,a100\n"
+           "   ActiveFeatures=x86,a100\n"
+           "   Gres=gpu:a100:4(S:0-1)\n"
+           "   NodeAddr=" + name + " NodeHostName=" + name + " Version=23.02.7\n"
+           "   OS=Linux 5.14.0 #1 SMP\n"
+           "   RealMemory=512000 AllocMem=" + std::to_string(alloc * 3900) + " FreeMem=401234 Sockets=2 Boards=1\n"
+           "   State=" + state + " ThreadsPerCore=1 TmpDisk=0 Weight=1 Owner=N/A MCS_label=N/A\n"
+           "   Partitions=short,long\n"
+           "   BootTime=2025-01-06T09:12:44 SlurmdStartTime=2025-01-06T09:14:02\n"
+           "   CfgTRES=cpu=128,mem=500G,billing=128,gres/gpu=4\n"
+           "   AllocTRES=cpu=" + std::to_string(alloc) + ",gres/gpu=" + std::to_string(alloc / 32) + "\n"
+           "   CapWatts=n/a\n"
+           "   CurrentWatts=0 AveWatts=0\n"
+           "\n";
+}
+
+inline std::string showNodes(int from, int to) {
+    std::string out;
+    for (int i = from; i < to; ++i) out += nodeRecord(i);
+    return out;
+}
+
+// `scontrol show node -o`: the same record on one line.
+inline std::string showNodesOneLine(int count) {
+    std::string out;
+    for (int i = 0; i < count; ++i) {
+        std::string rec = nodeRecord(i);
+        std::string line;
+        for (size_t p = 0; p < rec.size(); ++p) {
+            if (rec[p] == '\n') {
+                while (p + 1 < rec.size() && rec[p + 1] == ' ') ++p;
+                if (!line.empty() && line.back() != ' ') line += ' ';
+            } else {
+                line += rec[p];
+            }
+        }
+        while (!line.empty() && line.back() == ' ') line.pop_back();
+        out += line + "\n";
+    }
+    return out;
+}
+
+// `scontrol show jobid -dd` for a job spread over `nodes` nodes. Nodes are
+// grouped ten per allocation line with varying CPU_IDs, as Slurm does when
+// neighbouring nodes share a layout.
+inline std::string jobDetails(int nodes) {
+    std::string out =
+        "JobId=4242 JobName=bench_job\n"
+        "   UserId=bench(1000) GroupId=bench(1000) MCS_label=N/A\n"
+        "   Priority=10423 Nice=0 Account=proj QOS=normal\n"
+        "   JobState=RUNNING Reason=None Dependency=(null)\n"
+        "   Requeue=0 Restarts=0 BatchFlag=1 Reboot=0 ExitCode=0:0\n"
+        "   DerivedExitCode=0:0\n"
+        "   RunTime=03:14:15 TimeLimit=1-00:00:00 TimeMin=N/A\n"
+        "   SubmitTime=2025-01-07T08:00:00 EligibleTime=2025-01-07T08:00:00\n"
+        "   AccrueTime=2025-01-07T08:00:00\n"
+        "   StartTime=2025-01-07T08:05:00 EndTime=2025-01-08T08:05:00 Deadline=N/A\n"
+        "   Partition=short AllocNode:Sid=romeo1:1234\n"
+        "   NodeList=" + hostlist(0, nodes) + "\n"
+        "   NumNodes=" + std::to_string(nodes) + " NumCPUs=" + std::to_string(nodes * 64) +
+        " NumTasks=" + std::to_string(nodes) + " CPUs/Task=64 ReqB:S:C:T=0:0:*:*\n"
+        "   TRES=cpu=" + std::to_string(nodes * 64) + ",node=" + std::to_string(nodes) + ",gres/gpu=" + std::to_string(nodes * 2) + "\n"
+        "   JOB_GRES=gpu:a100:" + std::to_string(nodes * 2) + "\n";
+
+    for (int from = 0; from < nodes; from += 10) {
+        int to = std::min(nodes, from + 10);
+        std::string cpus = (from / 10) % 2 ? "0-31,64-95" : "0-63";
+        std::string idx = (from / 10) % 2 ? "0-1" : "2-3";
+        out += "     Nodes=" + hostlist(from, to) + " CPU_IDs=" + cpus + " Mem=249600 GRES=gpu:a100:2(IDX:" + idx + ")\n";
+    }
+
+    out += "   MinCPUsNode=64 MinMemoryNode=249600M MinTmpDiskNode=0\n"
+           "   Features=a100 DelayBoot=00:00:00\n"
+           "   OverSubscribe=OK Contiguous=0 Licenses=(null) Network=(null)\n"
+           "   Command=/home/bench/run.sh\n"
+           "   WorkDir=/home/bench\n"
+           "   StdErr=/home/bench/slurm-%j.err\n"
+           "   StdIn=/dev/null\n"
+           "   StdOut=/home/bench/slurm-%j.out\n";
+    return out;
+}
+
+// PARTITIONS_COMMAND columns: partition, avail, limit, nodes, state,
+// CPUs A/I/O/T, Gres, GresUsed.
+inline std::string sinfo(int partitions) {
+    static const char* states[] = {"idle", "mixed", "allocated", "drained", "down*"};
+    std::string out;
+    for (int p = 0; p < partitions; ++p) {
+        std::string name = "part" + std::to_string(p) + (p == 0 ? "*" : "");
+        for (int s = 0; s < 5; ++s) {
+            int nodes = 10 + (p * 7 + s * 3) % 90;
+            int total = nodes * 128;
+            int alloc = s == 0 ? 0 : s == 1 ? total / 2 : s == 2 ? total : 0;
+            int other = s >= 3 ? total : 0;
+            int used_gpus = s == 1 ? 2 : s == 2 ? 4 : 0;
+
+            out += name + " up 1-00:00:00 " + std::to_string(nodes) + " " + states[s] + " " +
+                   std::to_string(alloc) + "/" + std::to_string(total - alloc - other) + "/" +
+                   std::to_string(other) + "/" + std::to_string(total) +
+                   " gpu:mi250:4(S:0-1) gpu:mi250:" + std::to_string(used_gpus) + "(IDX:N/A)\n";
+        }
+    }
+    return out;
+}
+
+// `sacct -P` rows: every job followed by its batch and extern steps.
+inline std::string sacct(int rows) {
+    static const char* states[] = {"COMPLETED", "FAILED", "TIMEOUT", "CANCELLED by 1000", "OUT_OF_MEMORY"};
+    std::string out;
+    out.reserve(rows * 140);
+
+    for (int i = 0; i < rows; ++i) {
+        std::string id = std::to_string(100000 + i / 3);
+        std::string suffix = i % 3 == 0 ? "" : (i % 3 == 1 ? ".batch" : ".extern");
+        out += id + suffix + "|job_" + std::to_string(i % 50) + "|" + states[i % 5] +
+               "|2025-01-06T10:00:00|2025-01-06T11:02:03|01:02:03|0:0|" +
+               std::to_string((i * 7919) % 4000000) + "K|2-18:10:12|64|1|short|proj\n";
+    }
+    return out;
+}
+
+// Serves fixture output for the commands the api layer issues. Commands are
+// matched exactly (ignoring stderr redirections), then by longest prefix so
+// "sacct" answers any sacct invocation.
+struct Cluster {
+    std::map<std::string, std::string> outputs;
+
+    std::string operator()(const std::string& cmd, int*) const {
+        std::string key = cmd.substr(0, cmd.find(" 2>"));
+
+        auto exact = outputs.find(key);
+        if (exact != outputs.end()) return exact->second;
+
+        const std::string* best = nullptr;
+        size_t best_len = 0;
+        for (const auto& [prefix, output] : outputs) {
+            if (prefix.size() > best_len && key.compare(0, prefix.size(), prefix) == 0) {
+                best = &output;
+                best_len = prefix.size();
+            }
+        }
+        return best ? *best : "";
+    }
+
+    // Registers everything getJobDetails needs for a job over `nodes` nodes:
+    // the node records are asked at once for the comma-joined lists of all
+    // allocation lines.
+    void addJob(int nodes) {
+        outputs["scontrol show jobid -dd " + std::to_string(nodes)] = jobDetails(nodes);
+        std::string lists;
+        for (int from = 0; from < nodes; from += 10) {
+            lists += (lists.empty() ? "" : ",") + hostlist(from, std::min(nodes, from + 10));
+        }
+        outputs["scontrol show node " + lists] = showNodes(0, nodes);
+    }
+};
+
+}
@@ -0,0 +1,141 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace api {
+
+// Per query class circuit breaker, so rsv stops adding load to a controller
+// that is timing out. A class (see slurm::commandKey) opens after
+// FAILURES_TO_OPEN consecutive failures and rejects calls for a cooldown;
+// the first call after it is let through as a probe (half-open) and either
+// closes the breaker or reopens it with twice the cooldown. Meanwhile the
+// last good output of each command is served in place of a fresh one.
+class CircuitBreaker {
+public:
+    static constexpr int FAILURES_TO_OPEN = 3;
+    static constexpr std::chrono::seconds COOLDOWN{15};
+    static constexpr std::chrono::seconds MAX_COOLDOWN{240};
+
+    enum class State { Closed, Open, HalfOpen };
+
+    struct Stale {
+        std::string key;       // class serving old data, empty when all are fresh
+        std::time_t since = 0; // when its data was last good, 0 if never
+    };
+
+private:
+    struct Class {
+        State state = State::Closed;
+        int failures = 0;
+        std::chrono::steady_clock::time_point opened;
+        std::chrono::seconds cooldown = COOLDOWN;
+        std::time_t last_good = 0;
+        // the last call did not give fresh data
+        bool stale = false;
+    };
+
+    struct Output {
+        std::string data;
+        std::chrono::steady_clock::time_point taken;
+    };
+
+    // outputs above this are not kept (sacct windows have their own cache)
+    static constexpr size_t MAX_KEPT_OUTPUT = 4 << 20;
+
+    std::mutex m;
+    std::map<std::string, Class> classes;
+    std::map<std::string, Output> outputs;
+
+    // Drops outputs not refreshed for an hour once per-job commands pile up.
+    void prune(std::chrono::steady_clock::time_point now) {
+        if (outputs.size() < 512) return;
+        for (auto it = outputs.begin(); it != outputs.end(); ) {
+            if (now - it->second.taken > std::chrono::hours(1)) it = outputs.erase(it);
+            else ++it;
+        }
+    }
+
+public:
+    // Whether a command of class `key` may run now. An open class turns
+    // half-open once its cooldown is over and lets exactly one probe through.
+    bool allow(const std::string& key) {
+        std::lock_guard<std::mutex> lock(m);
+        Class& c = classes[key];
+
+        if (c.state == State::Closed) return true;
+        if (c.state == State::HalfOpen) return false;
+
+        if (std::chrono::steady_clock::now() - c.opened < c.cooldown) return false;
+        c.state = State::HalfOpen;
+        return true;
+    }
+
+    void success(const std::string& key, const std::string& cmd, const std::string& output) {
+        std::lock_guard<std::mutex> lock(m);
+        Class& c = classes[key];
+        c.state = State::Closed;
+        c.failures = 0;
+        c.cooldown = COOLDOWN;
+        c.last_good = std::time(nullptr);
+        c.stale = false;
+
+        auto now = std::chrono::steady_clock::now();
+        if (output.size() <= MAX_KEPT_OUTPUT) outputs[cmd] = Output{output, now};
+        prune(now);
+    }
+
+    void failure(const std::string& key) {
+        std::lock_guard<std::mutex> lock(m);
+        Class& c = classes[key];
+        c.stale = true;
+
+        if (c.state == State::HalfOpen) {
+            c.cooldown = std::min(c.cooldown * 2, MAX_COOLDOWN);
+        } else if (++c.failures < FAILURES_TO_OPEN) {
+            return;
+        }
+        c.state = State::Open;
+        c.opened = std::chrono::steady_clock::now();
+    }
+
+    // Marks `key` as serving old data for a call it rejected.
+    void rejected(const std::string& key) {
+        std::lock_guard<std::mutex> lock(m);
+        classes[key].stale = true;
+    }
+
+    // The last good output of exactly `cmd`, if any.
+    bool lastGood(const std::string& cmd, std::string& out) {
+        std::lock_guard<std::mutex> lock(m);
+        auto it = outputs.find(cmd);
+        if (it == outputs.end()) return false;
+        out = it->second.data;
+        return true;
+    }
+
+    State state(const std::string& key) {
+        std::lock_guard<std::mutex> lock(m);
+        auto it = classes.find(key);
+        return it == classes.end() ? State::Closed : it->second.state;
+    }
+
+    // The stale class whose data is oldest.
+    Stale stale() {
+        std::lock_guard<std::mutex> lock(m);
+        Stale s;
+        for (const auto& [key, c] : classes) {
+            if (!c.stale) continue;
+            if (s.key.empty() || c.last_good < s.since) {
+                s.key = key;
+                s.since = c.last_good;
+            }
+        }
+        return s;
+    }
+};
+
+}
@@ -0,0 +1,177 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "slurmjobs.hpp"
+#include "stats.hpp"
+
+namespace api {
+
+// seff-style efficiency of finished jobs, kept as columns (one entry per
+// job, like ClusterNodes) so a month of history is computed and summarised
+// with tight loops over contiguous arrays.
+struct EfficiencyTable {
+    // CPU time used (TotalCPU) over CPU time allocated (Elapsed × NCPUs)
+    std::vector<float> cpu;
+    // peak per-node use of the job's steps (MaxRSS × tasks per node) over
+    // the memory requested per node;
+    // negative when sacct reported no request or no usage
+    std::vector<float> mem;
+    std::vector<float> core_hours;
+
+    // dictionary codes into names / partitions / accounts
+    std::vector<int> name;
+    std::vector<int> partition;
+    std::vector<int> account;
+
+    std::vector<std::string> names;
+    std::vector<std::string> partitions;
+    std::vector<std::string> accounts;
+    std::unordered_map<std::string, int> name_index;
+    std::unordered_map<std::string, int> partition_index;
+    std::unordered_map<std::string, int> account_index;
+
+    // history windows appended so far, of `windows` (0 until the first)
+    int windows_done = 0;
+    int windows = 0;
+
+    size_t size() const { return cpu.size(); }
+    bool loading() const { return windows == 0 || windows_done < windows; }
+};
+
+enum class EfficiencyBy { Name, Partition, Account };
+
+struct EfficiencyGroup {
+    std::string key;
+    int jobs = 0;
+    float cpu_p50 = 0, cpu_p90 = 0;
+    float mem_p50 = -1, mem_p90 = -1;
+    // allocated core-hours that did no work
+    float wasted_core_hours = 0;
+};
+
+namespace efficiency {
+
+// Memory requested per node: "4000Mc" is per CPU, "4000Mn" per node and a
+// bare size (Slurm 21.08 and later) the whole job.
+inline double requestedPerNode(const std::string& req_mem, int ncpus, int nnodes) {
+    if (req_mem.empty()) return 0;
+    double bytes = (double)slurm::parseMemory(req_mem);
+    char unit = req_mem.back();
+    if (unit == 'c') return bytes * ncpus / std::max(1, nnodes);
+    if (unit == 'n') return bytes;
+    return bytes / std::max(1, nnodes);
+}
+
+inline int code(std::unordered_map<std::string, int>& index, std::vector<std::string>& dict, const std::string& value) {
+    auto it = index.find(value);
+    if (it != index.end()) return it->second;
+    index.emplace(value, (int)dict.size());
+    dict.push_back(value);
+    return (int)dict.size() - 1;
+}
+
+// Adds the jobs of `history` that ran to an end (running and never-started
+// ones are left out) to `t`; history arrives a window at a time.
+inline void append(EfficiencyTable& t, const std::vector<JobHistory>& history) {
+    static Histogram& hist = stats::get("analytics:efficiency");
+    stats::Scope scope(hist);
+
+    // raw columns first, parsed once per row
+    std::vector<float> elapsed, used_cpu, ncpus, rss, requested;
+
+    for (const auto& job : history) {
+        if (job.state == "RUNNING" || job.state == "PENDING") continue;
+        double seconds = slurm::parseDuration(job.elapsed);
+        int cpus = std::atoi(job.ncpus.c_str());
+        if (seconds <= 0 || cpus <= 0) continue;
+
+        int nodes = std::max(1, std::atoi(job.nnodes.c_str()));
+        elapsed.push_back(seconds);
+        used_cpu.push_back(slurm::parseDuration(job.total_cpu));
+        ncpus.push_back(cpus);
+        rss.push_back(job.node_rss_bytes);
+        requested.push_back(requestedPerNode(job.req_mem, cpus, nodes));
+
+        t.name.push_back(code(t.name_index, t.names, job.name));
+        t.partition.push_back(code(t.partition_index, t.partitions, job.partition));
+        t.account.push_back(code(t.account_index, t.accounts, job.account));
+    }
+
+    size_t from = t.cpu.size();
+    size_t n = elapsed.size();
+    t.cpu.resize(from + n);
+    t.mem.resize(from + n);
+    t.core_hours.resize(from + n);
+
+    float* cpu = t.cpu.data() + from;
+    float* mem = t.mem.data() + from;
+    float* core_hours = t.core_hours.data() + from;
+    for (size_t i = 0; i < n; ++i) core_hours[i] = elapsed[i] * ncpus[i] / 3600.f;
+    for (size_t i = 0; i < n; ++i) cpu[i] = used_cpu[i] / (elapsed[i] * ncpus[i]);
+    for (size_t i = 0; i < n; ++i) mem[i] = requested[i] > 0 && rss[i] > 0 ? rss[i] / requested[i] : -1.f;
+}
+
+// Nearest-rank percentile of `values`, reordered in place.
+inline float percentile(std::vector<float>& values, float p) {
+    if (values.empty()) return -1;
+    // rank ceil(p × n), 1-based: p90 of 10 values is the 9th (the slack
+    // keeps float error in p from bumping an exact rank up)
+    size_t rank = (size_t)std::ceil((double)p * values.size() - 1e-4);
+    size_t k = std::min(values.size() - 1, rank > 0 ? rank - 1 : 0);
+    std::nth_element(values.begin(), values.begin() + k, values.end());
+    return values[k];
+}
+
+// One row per job name, partition or account, most wasted core-hours first.
+inline std::vector<EfficiencyGroup> summarize(const EfficiencyTable& t, EfficiencyBy by) {
+    const std::vector<int>& codes = by == EfficiencyBy::Name ? t.name
+                                  : by == EfficiencyBy::Partition ? t.partition : t.account;
+    const std::vector<std::string>& dict = by == EfficiencyBy::Name ? t.names
+                                         : by == EfficiencyBy::Partition ? t.partitions : t.accounts;
+
+    // rows bucketed by group code (counting sort), so each group is a slice
+    std::vector<size_t> start(dict.size() + 1, 0);
+    for (int c : codes) ++start[c + 1];
+    for (size_t g = 0; g < dict.size(); ++g) start[g + 1] += start[g];
+
+    std::vector<size_t> order(codes.size());
+    std::vector<size_t> fill(start.begin(), start.end() - 1);
+    for (size_t i = 0; i < codes.size(); ++i) order[fill[codes[i]]++] = i;
+
+    std::vector<EfficiencyGroup> groups;
+    std::vector<float> cpu, mem;
+    for (size_t g = 0; g < dict.size(); ++g) {
+        EfficiencyGroup group;
+        group.key = dict[g].empty() ? "(none)" : dict[g];
+        group.jobs = (int)(start[g + 1] - start[g]);
+        if (group.jobs == 0) continue;
+
+        cpu.clear();
+        mem.clear();
+        for (size_t k = start[g]; k < start[g + 1]; ++k) {
+            size_t i = order[k];
+            cpu.push_back(t.cpu[i]);
+            if (t.mem[i] >= 0) mem.push_back(t.mem[i]);
+            group.wasted_core_hours += t.core_hours[i] * std::max(0.f, 1.f - t.cpu[i]);
+        }
+
+        group.cpu_p50 = percentile(cpu, 0.5f);
+        group.cpu_p90 = percentile(cpu, 0.9f);
+        group.mem_p50 = percentile(mem, 0.5f);
+        group.mem_p90 = percentile(mem, 0.9f);
+        groups.push_back(group);
+    }
+
+    std::sort(groups.begin(), groups.end(), [](const EfficiencyGroup& a, const EfficiencyGroup& b) {
+        return a.wasted_core_hours > b.wasted_core_hours;
+    });
+    return groups;
+}
+
+}
+
+}
@@ -0,0 +1,221 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "slurmjobs.hpp"
+#include "../components/reason_decoder.hpp"
+
+namespace api {
+
+// `rsv --export`: collects the user's queue and the partitions through
+// api::slurm (so rsvd and the single-flight layer apply) on a schedule and
+// publishes them as OpenMetrics, either rewritten into a textfile-collector
+// file or served to every client connecting to a Unix socket.
+namespace exporter {
+
+inline std::atomic<bool>& running() {
+    static std::atomic<bool> flag{true};
+    return flag;
+}
+
+inline std::string escapeLabel(const std::string& value) {
+    std::string out;
+    for (char c : value) {
+        if (c == '\\' || c == '"') out += '\\';
+        if (c == '\n') {
+            out += "\\n";
+            continue;
+        }
+        out += c;
+    }
+    return out;
+}
+
+inline std::string lower(std::string s) {
+    for (auto& c : s) c = std::tolower((unsigned char)c);
+    return s;
+}
+
+// One metric family: "# TYPE/HELP" header then one sample per label set.
+inline void family(std::ostringstream& out, const std::string& name, const std::string& help,
+                   const std::map<std::string, long>& samples) {
+    out << "# TYPE " << name << " gauge\n";
+    out << "# HELP " << name << " " << help << "\n";
+    for (const auto& [labels, value] : samples) {
+        out << name << "{" << labels << "} " << value << "\n";
+    }
+}
+
+inline std::string collect() {
+    auto start = std::chrono::steady_clock::now();
+
+    const char* env_user = std::getenv("USER");
+    std::string user = "user=\"" + escapeLabel(env_user ? env_user : "unknown") + "\"";
+
+    std::map<std::string, long> by_state, by_reason, cpus, gpus;
+    cpus[user] = 0;
+    gpus[user] = 0;
+
+    for (const auto& job : slurm::getUserJobs()) {
+        // array rows count every task; pending tasks share the row's reason
+        std::map<std::string, int> states = job.task_states;
+        if (!job.isArray()) states[job.state] = 1;
+
+        for (const auto& [state, count] : states) {
+            by_state[user + ",state=\"" + lower(escapeLabel(state)) + "\""] += count;
+        }
+
+        auto pending = states.find("PENDING");
+        if (pending != states.end()) {
+            std::string reason = ui::isKnownReason(job.reason) ? job.reason : "other";
+            by_reason[user + ",reason=\"" + reason + "\""] += pending->second;
+        }
+
+        if (job.isArray() || job.state == "RUNNING") {
+            cpus[user] += job.cpus;
+            gpus[user] += job.gpus;
+        }
+    }
+
+    std::map<std::string, long> part_nodes, part_cpus, part_gpus;
+    for (const auto& p : slurm::getPartitions()) {
+        std::string label = "partition=\"" + escapeLabel(p.name) + "\"";
+        part_nodes[label + ",state=\"idle\""] = p.nodes_idle;
+        part_nodes[label + ",state=\"mixed\""] = p.nodes_mix;
+        part_nodes[label + ",state=\"allocated\""] = p.nodes_alloc;
+        part_nodes[label + ",state=\"down\""] = p.nodes_down;
+        part_cpus[label + ",state=\"allocated\""] = p.cpus_alloc;
+        part_cpus[label + ",state=\"idle\""] = p.cpus_idle;
+        part_cpus[label + ",state=\"other\""] = p.cpus_other;
+        part_gpus[label + ",state=\"used\""] = p.gpus_used;
+        part_gpus[label + ",state=\"free\""] = p.gpus_total - p.gpus_used;
+    }
+
+    std::ostringstream out;
+    family(out, "rsv_jobs", "Jobs of the user by state, array tasks counted one by one.", by_state);
+    family(out, "rsv_pending_jobs", "Pending jobs of the user by Slurm reason.", by_reason);
+    family(out, "rsv_allocated_cpus", "CPUs held by running jobs of the user.", cpus);
+    family(out, "rsv_allocated_gpus", "GPUs held by running jobs of the user.", gpus);
+    family(out, "rsv_partition_nodes", "Nodes per partition and state.", part_nodes);
+    family(out, "rsv_partition_cpus", "CPUs per partition and state.", part_cpus);
+    family(out, "rsv_partition_gpus", "GPUs per partition, used or free.", part_gpus);
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    out << "# TYPE rsv_collect_duration_seconds gauge\n";
+    out << "# HELP rsv_collect_duration_seconds Time taken by the last collection.\n";
+    out << "rsv_collect_duration_seconds " << seconds << "\n";
+    out << "# EOF\n";
+    return out.str();
+}
+
+// Replaces `path` atomically so the collector never reads half a file.
+inline bool writeTextfile(const std::string& path, const std::string& metrics) {
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        if (!out) return false;
+        out << metrics;
+        if (!out) return false;
+    }
+    return std::rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+inline int listenUnix(const std::string& path) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) return -1;
+    std::strcpy(addr.sun_path, path.c_str());
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    unlink(path.c_str());
+    if (fd < 0 || bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(fd, 16) != 0) {
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+inline void stop(int) {
+    running() = false;
+}
+
+// `target` is a file path, or "unix:<path>" to serve over a socket. Runs
+// until SIGINT/SIGTERM.
+inline int run(const std::string& target, int interval_seconds) {
+    const std::string unix_prefix = "unix:";
+    bool serve = target.compare(0, unix_prefix.size(), unix_prefix) == 0;
+    std::string path = serve ? target.substr(unix_prefix.size()) : target;
+
+    int server_fd = -1;
+    if (serve) {
+        server_fd = listenUnix(path);
+        if (server_fd < 0) {
+            std::cerr << "rsv: cannot listen on " << path << ": " << std::strerror(errno) << "\n";
+            return 1;
+        }
+    }
+
+    std::signal(SIGINT, stop);
+    std::signal(SIGTERM, stop);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    std::string metrics;
+    auto next = std::chrono::steady_clock::now();
+
+    while (running()) {
+        auto now = std::chrono::steady_clock::now();
+        if (now >= next) {
+            metrics = collect();
+            if (!serve && !writeTextfile(path, metrics)) {
+                std::cerr << "rsv: cannot write " << path << "\n";
+            }
+            next = now + std::chrono::seconds(interval_seconds);
+        }
+
+        long wait = std::max<long>(0, std::chrono::duration_cast<std::chrono::milliseconds>(next - now).count());
+        if (!serve) {
+            // short sleeps so a signal is noticed promptly
+            usleep(std::min<long>(wait, 500) * 1000);
+            continue;
+        }
+
+        pollfd pfd{server_fd, POLLIN, 0};
+        if (poll(&pfd, 1, std::min<long>(wait, 500)) <= 0) continue;
+
+        int client = accept4(server_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client < 0) continue;
+
+        size_t sent = 0;
+        while (sent < metrics.size()) {
+            ssize_t n = write(client, metrics.data() + sent, metrics.size() - sent);
+            if (n <= 0) break;
+            sent += n;
+        }
+        close(client);
+    }
+
+    if (serve) {
+        close(server_fd);
+        unlink(path.c_str());
+    }
+    return 0;
+}
+
+}
+
+}
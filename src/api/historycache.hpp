@@ -0,0 +1,68 @@
+#pragma once
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace api {
+
+// On-disk cache of raw sacct output for time windows that are over and
+// whose jobs have all finished: accounting never changes for those, so a
+// long history only re-queries its most recent windows. One file per
+// window under $XDG_CACHE_HOME/rsv/sacct (or ~/.cache/rsv/sacct). The
+// queue-wait aggregates built from that history are kept there too.
+class HistoryCache {
+private:
+    std::string dir;
+
+public:
+    HistoryCache() {
+        const char* xdg = std::getenv("XDG_CACHE_HOME");
+        const char* home = std::getenv("HOME");
+        std::string base = xdg && *xdg ? xdg : home && *home ? std::string(home) + "/.cache" : "";
+        if (base.empty()) return;
+
+        for (const std::string& d : {base, base + "/rsv", base + "/rsv/sacct"}) mkdir(d.c_str(), 0700);
+        dir = base + "/rsv/sacct";
+    }
+
+    bool enabled() const { return !dir.empty(); }
+
+    std::string path(const std::string& key) const {
+        return dir + "/" + key;
+    }
+
+    bool load(const std::string& key, std::string& out) const {
+        if (!enabled()) return false;
+        std::ifstream in(path(key), std::ios::binary);
+        if (!in) return false;
+
+        std::ostringstream ss;
+        ss << in.rdbuf();
+        out = ss.str();
+        return true;
+    }
+
+    // Written aside and renamed so concurrent rsv instances never read half
+    // a window.
+    void store(const std::string& key, const std::string& data) const {
+        if (!enabled()) return;
+        std::string tmp = path(key) + ".tmp" + std::to_string(::getpid());
+        {
+            std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+            if (!out) return;
+            out << data;
+            if (!out) {
+                std::remove(tmp.c_str());
+                return;
+            }
+        }
+        std::rename(tmp.c_str(), path(key).c_str());
+    }
+};
+
+}
@@ -0,0 +1,273 @@
+#pragma once
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <queue>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace api {
+
+// Read-only view of many log files merged into one stream, for the log
+// modal of array and het jobs. Files are read a block at a time with pread
+// and merged with a k-way heap on the timestamp leading each line (lines
+// without one keep the previous line's), ties going to the lower file, so
+// files without timestamps come out one after another. Only the lines of
+// the requested window are produced; the merge state is checkpointed every
+// few thousand lines so scrolling back does not restart from the top.
+//
+// Logs of running jobs change underneath: the size seen at open is where a
+// file ends, and a file truncated since simply ends earlier (a mapping
+// would fault on the pages that went away).
+class MergedLog {
+public:
+    struct Line {
+        int source;
+        std::string_view text;
+    };
+
+    explicit MergedLog(const std::vector<std::string>& paths) {
+        files.reserve(paths.size());
+        for (const auto& path : paths) files.push_back(open(path));
+
+        checkpoint_every = std::max<size_t>(4096, files.size() * 8);
+        reset(State{std::vector<size_t>(files.size(), 0), std::vector<int64_t>(files.size(), 0)});
+        checkpoints.push_back(state);
+    }
+
+    MergedLog(const MergedLog&) = delete;
+    MergedLog& operator=(const MergedLog&) = delete;
+
+    // Lines [first, first + count); fewer once the end is reached. The text
+    // stays valid until the next call.
+    std::vector<Line> window(size_t first, size_t count) {
+        size_t checkpoint = std::min(first / checkpoint_every, checkpoints.size() - 1);
+        if (position > first || position < checkpoint * checkpoint_every) {
+            reset(checkpoints[checkpoint]);
+            position = checkpoint * checkpoint_every;
+        }
+
+        Line line;
+        while (position < first && next(line)) {}
+
+        // lines point into the read blocks, which the next line may replace
+        window_text.clear();
+        std::vector<std::pair<int, size_t>> ends;
+        while (ends.size() < count && next(line)) {
+            window_text.append(line.text);
+            ends.emplace_back(line.source, window_text.size());
+        }
+
+        std::vector<Line> out;
+        size_t begin = 0;
+        for (const auto& [source, end] : ends) {
+            out.push_back(Line{source, std::string_view(window_text).substr(begin, end - begin)});
+            begin = end;
+        }
+        return out;
+    }
+
+    // Merges through to the end once and returns the number of lines.
+    size_t size() {
+        if (!complete) window(SIZE_MAX - 1, 0);
+        return total;
+    }
+
+    // Lines seen so far; exact once the end has been reached.
+    size_t knownLines() const { return complete ? total : std::max(total, position); }
+    bool isComplete() const { return complete; }
+
+    // Files that were missing or unreadable.
+    int missing() const {
+        return std::count_if(files.begin(), files.end(), [](const File& f) { return !f.readable; });
+    }
+
+private:
+    struct File {
+        std::string path;
+        size_t size = 0;
+        bool readable = false;
+        // the bytes at [block_at, block_at + block.size())
+        std::string block;
+        size_t block_at = 0;
+    };
+
+    static constexpr size_t BLOCK = 64 * 1024;
+
+    struct State {
+        std::vector<size_t> offsets;  // start of each file's next line
+        std::vector<int64_t> keys;    // key of the last line taken from each file
+    };
+
+    using Head = std::pair<int64_t, int>;  // (key of the file's next line, file)
+
+    std::vector<File> files;
+    State state;
+    std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heap;
+    std::vector<State> checkpoints;
+    size_t checkpoint_every = 4096;
+    size_t position = 0;
+    size_t total = 0;
+    bool complete = false;
+    std::string window_text;
+
+    static File open(const std::string& path) {
+        File f;
+        f.path = path;
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return f;
+
+        struct stat st;
+        if (fstat(fd, &st) == 0) {
+            f.readable = true;
+            f.size = st.st_size;
+        }
+        close(fd);
+        return f;
+    }
+
+    // Reads `length` bytes at `at` into the file's block, reopening the file
+    // so 1000 logs need no 1000 fds. A short read means the file was
+    // truncated, and it now ends there.
+    static void load(File& file, size_t at, size_t length) {
+        length = std::min(length, file.size - at);
+        file.block.resize(length);
+        file.block_at = at;
+
+        size_t got = 0;
+        int fd = ::open(file.path.c_str(), O_RDONLY | O_CLOEXEC);
+        while (fd >= 0 && got < length) {
+            ssize_t n = pread(fd, &file.block[got], length - got, at + got);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;
+            got += n;
+        }
+        if (fd >= 0) close(fd);
+
+        if (got < length) {
+            file.block.resize(got);
+            file.size = at + got;
+        }
+    }
+
+    // What the block holds from `at` on, empty when it does not cover `at`.
+    static std::string_view held(const File& file, size_t at) {
+        if (at < file.block_at || at > file.block_at + file.block.size()) return {};
+        return std::string_view(file.block).substr(at - file.block_at);
+    }
+
+    // The bytes from `at` on, at least `length` of them unless the file ends
+    // first.
+    static std::string_view bytes(File& file, size_t at, size_t length) {
+        std::string_view rest = held(file, at);
+        if (rest.size() >= std::min(length, file.size - std::min(at, file.size))) return rest;
+        load(file, at, std::max(length, BLOCK));
+        return held(file, at);
+    }
+
+    // The line at `at` with its newline, if it has one.
+    static std::string_view lineAt(File& file, size_t at) {
+        size_t length = BLOCK;
+        for (;;) {
+            std::string_view rest = held(file, at);
+            size_t eol = rest.find('\n');
+            if (eol != std::string_view::npos) return rest.substr(0, eol + 1);
+            if (at + rest.size() >= file.size) return rest;
+
+            // past the block, or a line longer than it
+            length = std::max(length, rest.size() * 2);
+            load(file, at, length);
+        }
+    }
+
+    // "YYYY-MM-DD[T ]HH:MM:SS" or "HH:MM:SS" at the start of a line (after
+    // an optional '['), as YYYYMMDDHHMMSS; 0 when there is none.
+    static int64_t timestampKey(const char* p, size_t n) {
+        if (n > 0 && *p == '[') {
+            ++p;
+            --n;
+        }
+
+        auto digits = [&](size_t at, size_t count, int64_t& value) {
+            if (at + count > n) return false;
+            for (size_t i = at; i < at + count; ++i) {
+                if (p[i] < '0' || p[i] > '9') return false;
+                value = value * 10 + (p[i] - '0');
+            }
+            return true;
+        };
+
+        int64_t key = 0;
+        if (n >= 19 && p[4] == '-' && p[7] == '-' && (p[10] == 'T' || p[10] == ' ') && p[13] == ':' && p[16] == ':' &&
+            digits(0, 4, key) && digits(5, 2, key) && digits(8, 2, key) &&
+            digits(11, 2, key) && digits(14, 2, key) && digits(17, 2, key)) {
+            return key;
+        }
+
+        key = 0;
+        if (n >= 8 && p[2] == ':' && p[5] == ':' && digits(0, 2, key) && digits(3, 2, key) && digits(6, 2, key)) {
+            return key;
+        }
+        return 0;
+    }
+
+    int64_t headKey(int f) {
+        std::string_view head = bytes(files[f], state.offsets[f], 32);
+        int64_t key = timestampKey(head.data(), std::min<size_t>(head.size(), 32));
+        return key ? key : state.keys[f];
+    }
+
+    void reset(const State& from) {
+        state = from;
+        heap = {};
+        for (int f = 0; f < (int)files.size(); ++f) {
+            if (state.offsets[f] < files[f].size) heap.push({headKey(f), f});
+        }
+    }
+
+    bool next(Line& line) {
+        if (heap.empty()) {
+            complete = true;
+            total = position;
+            return false;
+        }
+
+        auto [key, f] = heap.top();
+        heap.pop();
+
+        File& file = files[f];
+        size_t begin = state.offsets[f];
+        if (begin >= file.size) return next(line);  // truncated since it was queued
+        std::string_view text = lineAt(file, begin);
+        if (text.empty()) return next(line);
+
+        state.offsets[f] = begin + text.size();
+        state.keys[f] = key;
+        if (!text.empty() && text.back() == '\n') text.remove_suffix(1);
+        if (!text.empty() && text.back() == '\r') text.remove_suffix(1);
+
+        if (state.offsets[f] < file.size) {
+            int64_t head = headKey(f);
+            // headKey may have read another block over the line
+            text = lineAt(file, begin).substr(0, text.size());
+            heap.push({head, f});
+        }
+        line = Line{f, text};
+
+        ++position;
+        total = std::max(total, position);
+        if (position % checkpoint_every == 0 && position / checkpoint_every == checkpoints.size()) {
+            checkpoints.push_back(state);
+        }
+        return true;
+    }
+};
+
+}
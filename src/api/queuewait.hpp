@@ -0,0 +1,276 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <functional>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "historycache.hpp"
+#include "slurmjobs.hpp"
+#include "stats.hpp"
+
+namespace api {
+
+// The shape of a job as queue waits are bucketed: node count, GPU count and
+// time limit (0 for none).
+struct WaitShape {
+    int nodes = 1;
+    int gpus = 0;
+    double limit_seconds = 0;
+};
+
+struct WaitStats {
+    int jobs = 0;
+    // seconds, negative without jobs
+    double p50 = -1, p90 = -1;
+    // from jobs of the asked shape rather than the whole partition
+    bool exact = false;
+};
+
+// Queue waits (Start − Submit) of started jobs, as a histogram per partition
+// and job shape. Jobs are folded in once: `watermark` is the latest start
+// counted, so an update only adds the jobs started after it.
+class QueueWaits {
+public:
+    // upper edges of the histogram bins, in seconds; the last bin is open
+    static constexpr std::array<long, 15> EDGES = {
+        30, 60, 120, 300, 600, 1200, 1800, 3600, 7200, 14400, 28800, 43200, 86400, 172800, 345600,
+    };
+    static constexpr int BINS = EDGES.size() + 1;
+    // a bucket above this many jobs is halved, so old waits fade out
+    static constexpr long MAX_JOBS = 2000;
+    // fewer jobs of the asked shape fall back to the whole partition
+    static constexpr int MIN_JOBS = 5;
+
+    using Bins = std::array<long, BINS>;
+
+    std::time_t watermark = 0;
+    // jobs started at the watermark second, which a later update sees again
+    std::set<std::string> at_watermark;
+
+    // partition → "nodes gpus limit" bucket → histogram
+    std::map<std::string, std::map<std::string, Bins>> buckets;
+
+    static int nodesBucket(int nodes) { return nodes <= 1 ? 0 : nodes <= 4 ? 1 : nodes <= 16 ? 2 : 3; }
+    static int gpusBucket(int gpus) { return gpus <= 0 ? 0 : gpus == 1 ? 1 : gpus <= 4 ? 2 : 3; }
+    static int limitBucket(double seconds) {
+        if (seconds <= 0) return 3;
+        return seconds <= 3600 ? 0 : seconds <= 14400 ? 1 : seconds <= 86400 ? 2 : 3;
+    }
+
+    static std::string shapeKey(const WaitShape& s) {
+        return std::to_string(nodesBucket(s.nodes)) + " " + std::to_string(gpusBucket(s.gpus)) + " " +
+               std::to_string(limitBucket(s.limit_seconds));
+    }
+
+    // "2-4 nodes · 0 GPUs · ≤4h"
+    static std::string shapeLabel(const WaitShape& s) {
+        static const char* nodes[] = {"1 node", "2-4 nodes", "5-16 nodes", "17+ nodes"};
+        static const char* gpus[] = {"0 GPUs", "1 GPU", "2-4 GPUs", "5+ GPUs"};
+        static const char* limits[] = {"≤1h", "≤4h", "≤1d", ">1d"};
+        return std::string(nodes[nodesBucket(s.nodes)]) + " · " + gpus[gpusBucket(s.gpus)] + " · " +
+               limits[limitBucket(s.limit_seconds)];
+    }
+
+    // Local "2025-03-01T12:00:00" as sacct prints it; 0 for "Unknown", "None".
+    static std::time_t parseTime(const std::string& s) {
+        std::tm tm{};
+        if (std::sscanf(s.c_str(), "%d-%d-%dT%d:%d:%d", &tm.tm_year, &tm.tm_mon, &tm.tm_mday,
+                        &tm.tm_hour, &tm.tm_min, &tm.tm_sec) != 6) return 0;
+        tm.tm_year -= 1900;
+        tm.tm_mon -= 1;
+        tm.tm_isdst = -1;
+        return std::mktime(&tm);
+    }
+
+    // Folds in the jobs of `history` that started after the watermark. The
+    // whole batch is held against the watermark it started with, since
+    // history comes newest first.
+    void add(const std::vector<JobHistory>& history) {
+        std::time_t since = watermark;
+        std::set<std::string> seen = at_watermark;
+
+        for (const auto& job : history) {
+            std::time_t start = parseTime(job.start);
+            std::time_t submit = parseTime(job.submit);
+            if (!start || !submit || start < submit || job.partition.empty()) continue;
+            if (start < since || (start == since && seen.count(job.id))) continue;
+
+            WaitShape shape;
+            shape.nodes = std::max(1, std::atoi(job.nnodes.c_str()));
+            shape.gpus = std::max(0, slurm::tresGpus(job.alloc_tres));
+            shape.limit_seconds = slurm::parseDuration(job.time_limit);
+
+            Bins& h = buckets[job.partition][shapeKey(shape)];
+            long wait = start - submit;
+            ++h[std::upper_bound(EDGES.begin(), EDGES.end(), wait) - EDGES.begin()];
+
+            long total = 0;
+            for (long c : h) total += c;
+            if (total > MAX_JOBS) {
+                for (long& c : h) c = (c + 1) / 2;
+            }
+
+            if (start > watermark) {
+                watermark = start;
+                at_watermark.clear();
+            }
+            if (start == watermark) at_watermark.insert(job.id);
+        }
+    }
+
+    // Percentile `p` of a histogram, interpolated within its bin.
+    static double percentile(const Bins& h, long total, double p) {
+        double rank = p * total;
+        long below = 0;
+        for (int bin = 0; bin < BINS; ++bin) {
+            if (h[bin] == 0 || below + h[bin] < rank) {
+                below += h[bin];
+                continue;
+            }
+            double lo = bin == 0 ? 0 : EDGES[bin - 1];
+            if (bin == BINS - 1) return lo;
+            return lo + (EDGES[bin] - lo) * std::max(0.0, rank - below) / h[bin];
+        }
+        return EDGES.back();
+    }
+
+    // Waits on `partition` for jobs of `shape`, or for all its jobs when
+    // there is no shape or too few jobs of it.
+    WaitStats stats(const std::string& partition, const WaitShape* shape = nullptr) const {
+        WaitStats s;
+        auto part = buckets.find(partition);
+        if (part == buckets.end()) return s;
+
+        Bins sum{};
+        auto total = [&] {
+            long n = 0;
+            for (long c : sum) n += c;
+            return n;
+        };
+
+        if (shape) {
+            auto it = part->second.find(shapeKey(*shape));
+            if (it != part->second.end()) sum = it->second;
+            s.exact = total() >= MIN_JOBS;
+        }
+        if (!s.exact) {
+            sum = Bins{};
+            for (const auto& [key, h] : part->second) {
+                for (int bin = 0; bin < BINS; ++bin) sum[bin] += h[bin];
+            }
+        }
+
+        long n = total();
+        if (n == 0) return s;
+        s.jobs = n;
+        s.p50 = percentile(sum, n, 0.5);
+        s.p90 = percentile(sum, n, 0.9);
+        return s;
+    }
+
+    // Line-based text: "watermark T", "seen ID", then one
+    // "bucket partition nodes gpus limit count…" line per shape.
+    std::string serialize() const {
+        std::ostringstream out;
+        out << "watermark " << (long long)watermark << "\n";
+        for (const auto& id : at_watermark) out << "seen " << id << "\n";
+        for (const auto& [partition, shapes] : buckets) {
+            for (const auto& [key, h] : shapes) {
+                out << "bucket " << partition << " " << key;
+                for (long c : h) out << " " << c;
+                out << "\n";
+            }
+        }
+        return out.str();
+    }
+
+    static QueueWaits parse(const std::string& data) {
+        QueueWaits w;
+        std::istringstream in(data);
+        for (std::string line; std::getline(in, line); ) {
+            std::istringstream ls(line);
+            std::string tag;
+            ls >> tag;
+            if (tag == "watermark") {
+                long long t = 0;
+                ls >> t;
+                w.watermark = t;
+            } else if (tag == "seen") {
+                std::string id;
+                if (ls >> id) w.at_watermark.insert(id);
+            } else if (tag == "bucket") {
+                std::string partition;
+                int nodes = 0, gpus = 0, limit = 0;
+                Bins h{};
+                if (!(ls >> partition >> nodes >> gpus >> limit)) continue;
+                for (long& c : h) ls >> c;
+                if (!ls) continue;
+                w.buckets[partition][std::to_string(nodes) + " " + std::to_string(gpus) + " " + std::to_string(limit)] = h;
+            }
+        }
+        return w;
+    }
+};
+
+namespace queuewait {
+
+// history looked at when nothing has been counted yet
+constexpr int DAYS = 30;
+
+inline std::string cacheKey() {
+    const char* user = std::getenv("USER");
+    return std::string("queuewait-") + (user ? user : "unknown") + "-v1";
+}
+
+// The aggregates as last stored, empty when there are none or when commands
+// are served by a runner (replay, bench) rather than Slurm.
+inline QueueWaits load() {
+    static const HistoryCache cache;
+    std::string data;
+    if (slurm::hasRunner()) return QueueWaits();
+    return cache.load(cacheKey(), data) ? QueueWaits::parse(data) : QueueWaits();
+}
+
+// Adds the jobs started since the stored aggregates were last updated and
+// stores them back; only the days after the watermark are asked of sacct.
+// `keep_going` is polled between windows; an abandoned update stores nothing,
+// and neither does one answered by a runner.
+inline QueueWaits update(std::function<bool()> keep_going = nullptr) {
+    static const HistoryCache cache;
+    static Histogram& hist = stats::get("analytics:queuewait");
+
+    QueueWaits waits = load();
+
+    int days = DAYS;
+    if (waits.watermark) {
+        long behind = (long)(std::time(nullptr) - waits.watermark) / 86400 + 1;
+        days = (int)std::clamp<long>(behind, 1, DAYS);
+    }
+
+    bool complete = false;
+    auto history = slurm::getJobHistory("", days, [&](const std::vector<JobHistory>&, int done, int total) {
+        // a window can be cut short once asked to stop, so it never counts
+        bool go = !keep_going || keep_going();
+        complete = done == total && go;
+        return go;
+    });
+    if (!complete) return waits;
+
+    {
+        stats::Scope scope(hist);
+        waits.add(history);
+    }
+    if (!slurm::hasRunner()) cache.store(cacheKey(), waits.serialize());
+    return waits;
+}
+
+}
+
+}
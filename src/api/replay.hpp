@@ -0,0 +1,261 @@
+#pragma once
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include "slurmjobs.hpp"
+#include "stats.hpp"
+
+namespace api {
+
+// Record and replay of everything that goes through slurm::exec, so a
+// session on a production cluster can be rerun offline.
+//
+// A recording is <dir>/commands.gz, a gzip stream (through the gzip binary,
+// rsv links no compression library) of two kinds of records:
+//
+//   O <id> <bytes>\n<output>                  an output, stored once
+//   C <offset_ms> <duration_us> <id> <cmd>\n  a command and which output it gave
+//
+// Identical outputs of a polled command share one O record. Local dates in
+// commands (sacct windows) are stored as days from the session's first day,
+// "@-1T00:00:00", so a recording replays on any later date.
+namespace replay {
+
+inline std::string logPath(const std::string& dir) {
+    return dir + "/commands.gz";
+}
+
+// Days since 1970-01-01 of a proleptic Gregorian date.
+inline long civilDays(int y, int m, int d) {
+    y -= m <= 2;
+    long era = (y >= 0 ? y : y - 399) / 400;
+    long yoe = y - era * 400;
+    long doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    return era * 146097 + yoe * 365 + yoe / 4 - yoe / 100 + doy - 719468;
+}
+
+// `cmd` with each "2025-03-01T00:00:00" made relative to the local day of
+// `origin`.
+inline std::string relativeDates(const std::string& cmd, std::time_t origin) {
+    static const std::regex date(R"((\d{4})-(\d{2})-(\d{2})T(\d{2}:\d{2}:\d{2}))");
+    if (cmd.find('T') == std::string::npos) return cmd;
+
+    std::tm tm{};
+    localtime_r(&origin, &tm);
+    long today = civilDays(tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday);
+
+    std::string out;
+    auto last = cmd.cbegin();
+    for (std::sregex_iterator it(cmd.begin(), cmd.end(), date), end; it != end; ++it) {
+        const std::smatch& m = *it;
+        long day = civilDays(std::stoi(m[1].str()), std::stoi(m[2].str()), std::stoi(m[3].str())) - today;
+        out.append(last, m[0].first);
+        out += "@" + std::to_string(day) + "T" + m[4].str();
+        last = m[0].second;
+    }
+    out.append(last, cmd.cend());
+    return out;
+}
+
+inline std::string quote(const std::string& s) {
+    std::string out = "'";
+    for (char c : s) {
+        if (c == '\'') out += "'\\''";
+        else out += c;
+    }
+    return out + "'";
+}
+
+class Recorder {
+private:
+    std::mutex m;
+    FILE* out = nullptr;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::time_t origin = std::time(nullptr);
+    std::map<std::pair<size_t, size_t>, int> seen;  // (hash, size) -> output id
+
+public:
+    // popen of the shell succeeds whatever gzip then finds, so the log is
+    // created here first to tell an unwritable directory.
+    bool open(const std::string& dir) {
+        if (mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST) return false;
+        FILE* probe = std::fopen(logPath(dir).c_str(), "w");
+        if (!probe) return false;
+        std::fclose(probe);
+
+        out = popen(("gzip -c > " + quote(logPath(dir))).c_str(), "w");
+        return out != nullptr;
+    }
+
+    void add(const std::string& cmd, const std::string& output, long long duration_us) {
+        auto offset_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count();
+
+        std::lock_guard<std::mutex> lock(m);
+        if (!out) return;
+
+        auto key = std::make_pair(std::hash<std::string>{}(output), output.size());
+        auto it = seen.find(key);
+        if (it == seen.end()) {
+            it = seen.emplace(key, (int)seen.size()).first;
+            std::fprintf(out, "O %d %zu\n", it->second, output.size());
+            std::fwrite(output.data(), 1, output.size(), out);
+        }
+        std::fprintf(out, "C %lld %lld %d %s\n", (long long)offset_ms, duration_us, it->second,
+                     relativeDates(cmd, origin).c_str());
+    }
+
+    ~Recorder() {
+        if (out) pclose(out);
+    }
+};
+
+struct Entry {
+    long long offset_ms;
+    long long duration_us;
+    int output;
+};
+
+class Player {
+private:
+    std::mutex m;
+    std::vector<std::string> outputs;
+    std::unordered_map<std::string, std::vector<Entry>> commands;
+    std::unordered_map<std::string, size_t> cursor;
+    double speed = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::time_t origin = std::time(nullptr);
+
+public:
+    bool load(const std::string& dir, double replay_speed) {
+        speed = replay_speed;
+
+        std::unique_ptr<FILE, int(*)(FILE*)> pipe(
+            popen(("gzip -dc " + quote(logPath(dir)) + " 2>/dev/null").c_str(), "r"),
+            static_cast<int(*)(FILE*)>(pclose)
+        );
+        if (!pipe) return false;
+
+        std::string data;
+        char buffer[65536];
+        for (size_t n; (n = std::fread(buffer, 1, sizeof(buffer), pipe.get())) > 0; ) data.append(buffer, n);
+
+        size_t pos = 0;
+        while (pos < data.size()) {
+            size_t eol = data.find('\n', pos);
+            if (eol == std::string::npos) break;
+            std::string header = data.substr(pos, eol - pos);
+            pos = eol + 1;
+
+            std::istringstream iss(header);
+            char kind = 0;
+            iss >> kind;
+            if (kind == 'O') {
+                int id = 0;
+                size_t size = 0;
+                iss >> id >> size;
+                if (id != (int)outputs.size() || pos + size > data.size()) return false;
+                outputs.push_back(data.substr(pos, size));
+                pos += size;
+            } else if (kind == 'C') {
+                Entry e{};
+                iss >> e.offset_ms >> e.duration_us >> e.output;
+                std::string cmd;
+                std::getline(iss >> std::ws, cmd);
+                if (e.output < 0 || e.output >= (int)outputs.size()) return false;
+                commands[relativeDates(cmd, origin)].push_back(e);
+            } else {
+                return false;
+            }
+        }
+
+        start = std::chrono::steady_clock::now();
+        origin = std::time(nullptr);
+        return !commands.empty();
+    }
+
+    // Speed 0 hands out each command's outputs in recorded order as fast as
+    // asked (the last one repeats). A positive speed follows the recorded
+    // timeline scaled by it, including each command's latency. A command
+    // missing from the recording fails like one exiting 1, so an scancel
+    // never passes for done.
+    std::string run(const std::string& cmd, int* status) {
+        static Histogram& miss_hist = stats::get("replay:miss");
+
+        const Entry* entry = nullptr;
+        std::string output;
+        {
+            std::lock_guard<std::mutex> lock(m);
+            auto it = commands.find(relativeDates(cmd, origin));
+            if (it == commands.end()) {
+                miss_hist.record(0, 0);
+                *status = 1;
+                return "";
+            }
+
+            const auto& entries = it->second;
+            if (speed <= 0) {
+                size_t& next = cursor[cmd];
+                entry = &entries[std::min(next, entries.size() - 1)];
+                ++next;
+            } else {
+                auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - start).count() * speed;
+                entry = &entries.front();
+                for (const auto& e : entries) {
+                    if (e.offset_ms > elapsed_ms) break;
+                    entry = &e;
+                }
+            }
+            output = outputs[entry->output];
+        }
+
+        if (speed > 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds((long long)(entry->duration_us / speed)));
+        }
+        return output;
+    }
+};
+
+// Routes slurm::exec through a recorder writing to `dir`.
+inline bool startRecording(const std::string& dir) {
+    static Recorder recorder;
+    if (!recorder.open(dir)) return false;
+
+    slurm::setRunner([](const std::string& cmd, int* status) {
+        auto start = std::chrono::steady_clock::now();
+        std::string output = slurm::shell(cmd, status);
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        recorder.add(cmd, output, us);
+        return output;
+    });
+    return true;
+}
+
+// Serves slurm::exec from the recording in `dir` instead of running Slurm.
+inline bool startReplay(const std::string& dir, double speed) {
+    static Player player;
+    if (!player.load(dir, speed)) return false;
+
+    slurm::setRunner([](const std::string& cmd, int* status) { return player.run(cmd, status); });
+    return true;
+}
+
+}
+
+}
@@ -0,0 +1,104 @@
+#pragma once
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace api {
+
+// Client side of the rsvd protocol. rsvd polls the cluster once per
+// interval and serves its snapshots over a Unix socket: the client sends one
+// request line ("jobs", "partitions" or "nodes") and reads
+// "OK <age_seconds>\n" followed by the raw command output until EOF. Jobs
+// are filtered to the connecting uid by the daemon.
+//
+// Its answers end up in command lines, so the client only talks to a
+// socket owned by root or RSVD_UID (the daemon's account), in a directory
+// nobody else can write to, and whose peer runs as one of them.
+namespace rsvd {
+
+constexpr int MAX_AGE_SECONDS = 90;
+constexpr const char* DEFAULT_SOCKET = "/run/rsvd/rsvd.sock";
+
+inline std::string socketPath() {
+    const char* path = std::getenv("RSVD_SOCKET");
+    return path && *path ? path : DEFAULT_SOCKET;
+}
+
+inline bool trustedUid(uid_t uid) {
+    const char* daemon = std::getenv("RSVD_UID");
+    return uid == 0 || (daemon && *daemon && uid == (uid_t)std::strtoul(daemon, nullptr, 10));
+}
+
+// Whether the socket at `path` can only have been put there by the daemon.
+inline bool trustedPath(const std::string& path) {
+    struct stat st{};
+    if (lstat(path.c_str(), &st) != 0 || !S_ISSOCK(st.st_mode) || !trustedUid(st.st_uid)) return false;
+
+    size_t slash = path.find_last_of('/');
+    std::string dir = slash == std::string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+    if (stat(dir.c_str(), &st) != 0 || !S_ISDIR(st.st_mode) || !trustedUid(st.st_uid)) return false;
+    return (st.st_mode & (S_IWGRP | S_IWOTH)) == 0;
+}
+
+// Fills `out` and returns true when the daemon answered with a snapshot
+// young enough to use; false means the caller should query Slurm itself.
+inline bool query(const std::string& request, std::string& out, int timeout_ms = 500) {
+    std::string path = socketPath();
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path) || !trustedPath(path)) return false;
+    std::strcpy(addr.sun_path, path.c_str());
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return false;
+
+    ucred peer{};
+    socklen_t peer_len = sizeof(peer);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &peer, &peer_len) != 0 || !trustedUid(peer.uid)) {
+        close(fd);
+        return false;
+    }
+
+    std::string line = request + "\n";
+    if (write(fd, line.data(), line.size()) != (ssize_t)line.size()) {
+        close(fd);
+        return false;
+    }
+
+    std::string response;
+    char buffer[65536];
+    pollfd pfd{fd, POLLIN, 0};
+    while (true) {
+        if (poll(&pfd, 1, timeout_ms) <= 0) {
+            close(fd);
+            return false;
+        }
+        ssize_t n = read(fd, buffer, sizeof(buffer));
+        if (n < 0) {
+            close(fd);
+            return false;
+        }
+        if (n == 0) break;
+        response.append(buffer, n);
+    }
+    close(fd);
+
+    size_t eol = response.find('\n');
+    if (eol == std::string::npos || response.compare(0, 3, "OK ") != 0) return false;
+    if (std::atoi(response.c_str() + 3) > MAX_AGE_SECONDS) return false;
+
+    out = response.substr(eol + 1);
+    return true;
+}
+
+}
+
+}
@@ -0,0 +1,175 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "slurmjobs.hpp"
+
+namespace api {
+
+template <typename T, size_t N>
+class RingBuffer {
+private:
+    std::array<T, N> data{};
+    size_t head = 0;
+    size_t count = 0;
+
+public:
+    void push(const T& value) {
+        data[head] = value;
+        head = (head + 1) % N;
+        if (count < N) count++;
+    }
+
+    size_t size() const { return count; }
+    static constexpr size_t capacity() { return N; }
+
+    // Oldest sample first.
+    const T& operator[](size_t i) const {
+        return data[(head + N - count + i) % N];
+    }
+
+    std::vector<T> values() const {
+        std::vector<T> out;
+        out.reserve(count);
+        for (size_t i = 0; i < count; ++i) out.push_back((*this)[i]);
+        return out;
+    }
+};
+
+struct JobUsage {
+    static constexpr size_t HISTORY = 60;
+
+    RingBuffer<float, HISTORY> busy_cores;
+    RingBuffer<float, HISTORY> rss_gib;
+    // largest memory in use on one node: each step's largest task RSS times
+    // its tasks per node, summed over steps
+    long long node_rss_bytes = 0;
+
+    double last_cpu_seconds = -1;
+    std::chrono::steady_clock::time_point last_sample;
+    std::chrono::steady_clock::time_point last_watched;
+};
+
+// Polls `sstat` for the job currently on screen from its own thread. Only the
+// watched job is sampled, so switching jobs or leaving a pending job selected
+// costs nothing; samples for previously watched jobs are kept for a while so
+// coming back to them shows their history.
+class UsageSampler {
+private:
+    static constexpr size_t MAX_JOBS = 16;
+
+    std::map<std::string, JobUsage> jobs;
+    std::string watched;
+
+    std::function<void()> on_sample;
+    std::chrono::seconds interval;
+
+    bool running = true;
+    std::mutex m;
+    std::condition_variable cv;
+    std::thread worker;
+
+    void sample(const std::string& job_id) {
+        auto steps = slurm::getJobUsage(job_id);
+        auto now = std::chrono::steady_clock::now();
+
+        double cpu_seconds = 0;
+        long long rss_bytes = 0;
+        long long node_rss_bytes = 0;
+        for (const auto& step : steps) {
+            cpu_seconds += step.cpu_seconds * step.ntasks;
+            rss_bytes = std::max(rss_bytes, step.max_rss_bytes);
+            node_rss_bytes += step.max_rss_bytes * ((step.ntasks + step.nnodes - 1) / step.nnodes);
+        }
+
+        std::lock_guard<std::mutex> lock(m);
+        auto& usage = jobs[job_id];
+        usage.node_rss_bytes = std::max(usage.node_rss_bytes, node_rss_bytes);
+
+        if (usage.last_cpu_seconds >= 0) {
+            double wall = std::chrono::duration<double>(now - usage.last_sample).count();
+            double busy = wall > 0 ? (cpu_seconds - usage.last_cpu_seconds) / wall : 0;
+            usage.busy_cores.push((float)std::max(0.0, busy));
+            usage.rss_gib.push((float)(rss_bytes / (1024.0 * 1024 * 1024)));
+        }
+        usage.last_cpu_seconds = cpu_seconds;
+        usage.last_sample = now;
+    }
+
+    void evict() {
+        while (jobs.size() > MAX_JOBS) {
+            auto oldest = jobs.begin();
+            for (auto it = jobs.begin(); it != jobs.end(); ++it) {
+                if (it->second.last_watched < oldest->second.last_watched) oldest = it;
+            }
+            jobs.erase(oldest);
+        }
+    }
+
+    void loop() {
+        std::unique_lock<std::mutex> lock(m);
+        while (running) {
+            if (watched.empty()) {
+                cv.wait(lock, [&] { return !running || !watched.empty(); });
+                continue;
+            }
+
+            std::string job_id = watched;
+            lock.unlock();
+            sample(job_id);
+            if (on_sample) on_sample();
+            lock.lock();
+
+            cv.wait_for(lock, interval, [&] { return !running || watched != job_id; });
+        }
+    }
+
+public:
+    UsageSampler(std::function<void()> on_sample, std::chrono::seconds interval = std::chrono::seconds(5))
+        : on_sample(std::move(on_sample)), interval(interval) {
+        worker = std::thread([this] { loop(); });
+    }
+
+    ~UsageSampler() {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            running = false;
+        }
+        cv.notify_all();
+        worker.join();
+    }
+
+    UsageSampler(const UsageSampler&) = delete;
+    UsageSampler& operator=(const UsageSampler&) = delete;
+
+    // Job to sample from now on; an empty id pauses sampling.
+    void watch(const std::string& job_id) {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            if (watched == job_id) return;
+            watched = job_id;
+            if (!job_id.empty()) {
+                jobs[job_id].last_watched = std::chrono::steady_clock::now();
+                evict();
+            }
+        }
+        cv.notify_all();
+    }
+
+    bool usage(const std::string& job_id, JobUsage& out) {
+        std::lock_guard<std::mutex> lock(m);
+        auto it = jobs.find(job_id);
+        if (it == jobs.end()) return false;
+        out = it->second;
+        return true;
+    }
+};
+
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include <chrono>
+#include <functional>
+#include <future>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace api {
+
+// Coalesces identical queries. While a fetch for a key is running, other
+// callers for the same key wait for its result instead of forking their own
+// command; once it has finished, the result is reused for `freshness` to
+// absorb bursts (auto-refresh, `r`, cancel and menu changes back to back).
+// Invalidating also detaches fetches in flight: they started before the
+// change that invalidated them, so later callers start a fetch of their own.
+template <typename T>
+class SingleFlight {
+private:
+    struct Entry {
+        std::shared_future<T> result;
+        std::chrono::steady_clock::time_point finished;
+        bool done = false;
+        // which flight this is, so a detached one never marks its successor
+        unsigned long generation = 0;
+    };
+
+    std::mutex m;
+    std::map<std::string, Entry> entries;
+    unsigned long generation = 0;
+    std::chrono::milliseconds freshness;
+
+    // Drops stale results so per-job keys do not pile up. Caller holds m.
+    void prune(std::chrono::steady_clock::time_point now) {
+        for (auto it = entries.begin(); it != entries.end(); ) {
+            if (it->second.done && now - it->second.finished >= freshness) it = entries.erase(it);
+            else ++it;
+        }
+    }
+
+public:
+    explicit SingleFlight(std::chrono::milliseconds freshness) : freshness(freshness) {}
+
+    T run(const std::string& key, const std::function<T()>& fetch) {
+        std::promise<T> promise;
+        std::shared_future<T> result;
+        bool leader = false;
+        unsigned long flight = 0;
+
+        {
+            std::lock_guard<std::mutex> lock(m);
+            auto now = std::chrono::steady_clock::now();
+
+            auto it = entries.find(key);
+            if (it != entries.end() && (!it->second.done || now - it->second.finished < freshness)) {
+                result = it->second.result;
+            } else {
+                prune(now);
+                result = promise.get_future().share();
+                flight = ++generation;
+                entries[key] = Entry{result, {}, false, flight};
+                leader = true;
+            }
+        }
+
+        if (!leader) return result.get();
+
+        try {
+            promise.set_value(fetch());
+        } catch (...) {
+            promise.set_exception(std::current_exception());
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m);
+            auto it = entries.find(key);
+            if (it != entries.end() && it->second.generation == flight) {
+                it->second.done = true;
+                it->second.finished = std::chrono::steady_clock::now();
+            }
+        }
+
+        return result.get();
+    }
+
+    // Forgets the result for `key` so the next call fetches again. A fetch
+    // in flight still answers the callers already waiting on it, but nobody
+    // joins it any more and its result is not kept.
+    void invalidate(const std::string& key) {
+        std::lock_guard<std::mutex> lock(m);
+        entries.erase(key);
+    }
+
+    void invalidateAll() {
+        std::lock_guard<std::mutex> lock(m);
+        entries.clear();
+    }
+};
+
+}
@@ -5,8 +5,35 @@
 #include <memory>
 #include <array>
 #include <sstream>
+#include <cstdio>
 #include <cstdlib>
 #include <regex>
+#include <map>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+#include <cctype>
+#include <chrono>
+#include <functional>
+#include <atomic>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <set>
+#include <thread>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "stats.hpp"
+#include "singleflight.hpp"
+#include "rsvd.hpp"
+#include "historycache.hpp"
+#include "breaker.hpp"
 
 namespace api {
 
@@ -14,6 +41,47 @@ struct Job {
     std::string id;
     std::string name;
     std::string entry_name;
+    std::string state;
+    std::string reason;
+
+    // Requested CPUs and GPUs; array rows sum them over running tasks.
+    int cpus = 0;
+    int gpus = 0;
+
+    // Job to fetch details for: the job itself, or one task of an array row.
+    std::string detail_id;
+
+    // Array rows stand for every task of an array (`id` is the array job id,
+    // `tasks` the merged task range); expanded tasks only set `array_id`.
+    std::string array_id;
+    std::string tasks;
+    int task_count = 0;
+    std::map<std::string, int> task_states;
+
+    bool isArray() const { return !tasks.empty(); }
+};
+
+// Outcome of a bulk cancel; `failed` pairs a job id with scancel's message.
+struct CancelResult {
+    std::vector<std::string> cancelled;
+    std::vector<std::pair<std::string, std::string>> failed;
+};
+
+// Values substituted into StdOut/StdErr filename patterns.
+struct LogContext {
+    std::string job_id;
+    std::string array_job_id;
+    std::string array_task_id;
+    std::string job_name;
+    std::string user;
+    std::string node;
+};
+
+// Log files of one job, array task ("3") or het component ("+1").
+struct LogSource {
+    std::string label;
+    std::string stdout_path;
+    std::string stderr_path;
 };
 
 struct NodeAllocation {
@@ -22,6 +90,36 @@ struct NodeAllocation {
     int allocated_gpus;
     int total_cores;
     int total_gpus;
+
+    // hardware layout; CPU ids number threads within cores within sockets
+    int sockets = 1;
+    int cores_per_socket = 0;
+    int threads_per_core = 1;
+
+    // indices of our GPUs (IDX), empty when Slurm did not list them
+    std::vector<int> gpu_ids;
+    // sockets local to each GPU of the node as a bitmask, 0 if unknown
+    std::vector<unsigned> gpu_affinity;
+
+    // megabytes: ours (Mem= of the allocation), then the node's RealMemory,
+    // AllocMem of every job and FreeMem (-1 when not reported)
+    long long mem_mb = 0;
+    long long real_memory_mb = 0;
+    long long alloc_memory_mb = 0;
+    long long free_memory_mb = -1;
+};
+
+// Size and layout of a node, from scontrol show node.
+struct NodeShape {
+    int cores = 0;
+    int gpus = 0;
+    int sockets = 1;
+    int cores_per_socket = 0;
+    int threads_per_core = 1;
+    std::vector<unsigned> gpu_affinity;
+    long long real_memory_mb = 0;
+    long long alloc_memory_mb = 0;
+    long long free_memory_mb = -1;
 };
 
 struct PartitionInfo {
@@ -33,6 +131,41 @@ struct PartitionInfo {
     int nodes_down = 0;
     std::string timelimit;
     std::string state;
+
+    // Summed over the partition's nodes; cpus_other is offline/drained.
+    int cpus_alloc = 0;
+    int cpus_idle = 0;
+    int cpus_other = 0;
+    int cpus_total = 0;
+    int gpus_used = 0;
+    int gpus_total = 0;
+};
+
+enum class NodeState : uint8_t {
+    Idle,
+    Mixed,
+    Allocated,
+    Drain,
+    Down,
+    Other,
+};
+
+// Whole-cluster node inventory, one entry per node, stored column-wise so
+// the heatmap can walk thousands of nodes without chasing pointers.
+struct ClusterNodes {
+    std::vector<std::string> names;
+    std::vector<std::string> partitions;
+    std::vector<int> cpu_alloc;
+    std::vector<int> cpu_total;
+    std::vector<int> gpu_used;
+    std::vector<int> gpu_total;
+    // megabytes; mem_free is -1 when the node does not report it
+    std::vector<long long> mem_total;
+    std::vector<long long> mem_alloc;
+    std::vector<long long> mem_free;
+    std::vector<NodeState> state;
+
+    size_t size() const { return names.size(); }
 };
 
 struct DetailedJob {
@@ -52,6 +185,83 @@ struct DetailedJob {
     std::string reason;
 
     std::vector<NodeAllocation> node_allocations;
+    // compressed node lists of the allocation lines, comma separated
+    std::string node_list;
+};
+
+// Another job holding cores on a node of ours.
+struct Tenant {
+    std::string job_id;
+    std::string user;
+    std::string name;
+    // its CPUs spread evenly over its nodes
+    int cpus = 0;
+};
+
+// Who else runs on one node of a job.
+struct NodeTenancy {
+    std::string node_name;
+    // cores allocated to every job on the node, ours included
+    int cpu_alloc = 0;
+    int total_cores = 0;
+    // the node's load average, negative if unknown
+    double cpu_load = -1;
+    // other jobs, most cores first
+    std::vector<Tenant> tenants;
+};
+
+struct StepUsage {
+    std::string step;
+    double cpu_seconds = 0;
+    long long max_rss_bytes = 0;
+    int ntasks = 1;
+    int nnodes = 1;
+    // average bytes read and written per task
+    long long disk_read_bytes = 0;
+    long long disk_write_bytes = 0;
+};
+
+// One step of a job (batch, extern, 0, 1, …) as sacct accounts it, with the
+// live figures of sstat while it runs.
+struct JobStep {
+    std::string id;
+    std::string name;
+    std::string state;
+    double elapsed_seconds = 0;
+    double cpu_seconds = 0;
+    int cpus = 0;
+    long long max_rss_bytes = 0;
+    // average bytes read and written per task
+    long long disk_read_bytes = 0;
+    long long disk_write_bytes = 0;
+    std::string node_list;
+    // the usage figures come from sstat
+    bool live = false;
+};
+
+// A pinned job on the dashboard: what squeue reports, with the job's share
+// of each node it holds.
+struct JobTile {
+    struct Node {
+        std::string name;
+        int cores = 0;
+        int total_cores = 0;
+        int gpus = 0;
+        int total_gpus = 0;
+    };
+
+    std::string id;
+    std::string name;
+    std::string state;
+    std::string partition;
+    std::string elapsed;
+    std::string limit;
+    int nodes = 0;
+    int cpus = 0;
+    int gpus = 0;
+    // false once the job has left the queue
+    bool listed = false;
+    std::vector<Node> allocation;
 };
 
 struct JobHistory {
@@ -68,26 +278,431 @@ struct JobHistory {
     std::string nnodes;
     std::string partition;
     std::string account;
+    std::string total_cpu;
+    std::string req_mem;
+    std::string submit;
+    std::string time_limit;
+    std::string alloc_tres;
+    // peak resident memory of the job on one node: the largest step's
+    // MaxRSS (one task) times its tasks per node
+    long long node_rss_bytes = 0;
 };
 
 class slurm {
-private:
-    static inline std::string exec(const std::string& cmd) {
-        std::array<char, 128> buffer;
+public:
+    // Identical queries issued within this window share one command.
+    static constexpr std::chrono::milliseconds FRESHNESS{2000};
+    // A command running longer is killed and counts against its breaker.
+    static constexpr std::chrono::milliseconds COMMAND_TIMEOUT{20000};
+
+    // Commands behind the shared cluster-wide queries, also polled by rsvd.
+    // JOBS_FORMAT is the squeue format of one user job line; squeue keeps
+    // pending array tasks compressed into one line unless -r is given.
+    static constexpr const char* JOBS_FORMAT = "%i %F %K %T %D %C %b %r %j";
+    static constexpr const char* PARTITIONS_COMMAND =
+        "sinfo -O \"Partition:40,Available:8,Time:16,Nodes:8,StateLong:24,CPUsState:40,Gres:120,GresUsed:160\""
+        " --noheader 2>/dev/null";
+    static constexpr const char* NODES_COMMAND = "scontrol show node -o 2>/dev/null";
+    static constexpr const char* HISTORY_FORMAT =
+        "JobID,JobName%30,State,Start,End,Elapsed,ExitCode,MaxRSS,CPUTime,NCPUs,NNodes,Partition,Account,TotalCPU,ReqMem,"
+        "Submit,Timelimit,AllocTRES,NTasks";
+    static constexpr int HISTORY_PARALLELISM = 4;
+    static constexpr const char* TILES_FORMAT = "%i|%T|%P|%M|%l|%D|%C|%b|%N|%j";
+
+    // Runs a shell command and returns its stdout. `status` comes in as 0
+    // and is set as shell() sets it.
+    using Runner = std::function<std::string(const std::string&, int* status)>;
+
+    // Replaces how commands are executed, e.g. to serve recorded output in
+    // benchmarks or replays. An empty runner restores popen.
+    static void setRunner(Runner r) {
+        runner() = std::move(r);
+    }
+
+    // Whether commands are served by a runner rather than Slurm; nothing
+    // they answer may end up in the on-disk caches.
+    static bool hasRunner() {
+        return (bool)runner();
+    }
+
+    // Histogram name for a command: the binary, plus the sub-command for
+    // scontrol ("scontrol show node"), so every query class gets its own row.
+    static inline std::string commandKey(const std::string& cmd) {
+        std::istringstream iss(cmd);
+        std::string word, key;
+        iss >> key;
+        if (key == "scontrol") {
+            for (int i = 0; i < 2 && iss >> word && word[0] != '-'; ++i) key += " " + word;
+        }
+        return "exec:" + key;
+    }
+
+    // How long a command may run before it is killed: COMMAND_TIMEOUT, or
+    // RSV_COMMAND_TIMEOUT seconds; sacct gets six times that.
+    static inline std::chrono::milliseconds timeoutFor(const std::string& cmd) {
+        std::chrono::milliseconds timeout = COMMAND_TIMEOUT;
+        const char* env = std::getenv("RSV_COMMAND_TIMEOUT");
+        if (env && std::atof(env) > 0) timeout = std::chrono::milliseconds((long)(std::atof(env) * 1000));
+        return cmd.compare(0, 6, "sacct ") == 0 ? timeout * 6 : timeout;
+    }
+
+    // Kills the commands still running and refuses new ones, so threads
+    // stuck behind a long sacct wind down at exit.
+    static void abortCommands() {
+        aborted() = true;
+    }
+
+    // Runs a shell command and returns its stdout. A command still running
+    // after timeoutFor(cmd), or when commands are aborted, is killed with its
+    // process group; `status` then gets -1, otherwise the exit status.
+    static inline std::string shell(const std::string& cmd, int* status = nullptr) {
+        if (status) *status = -1;
+        if (aborted()) return "";
+        auto deadline = std::chrono::steady_clock::now() + timeoutFor(cmd);
+
+        int fds[2];
+        if (pipe2(fds, O_CLOEXEC) != 0) return "";
+
+        pid_t pid = fork();
+        if (pid < 0) {
+            close(fds[0]);
+            close(fds[1]);
+            return "";
+        }
+        if (pid == 0) {
+            // own process group, so a timeout kills squeue and not just sh
+            setpgid(0, 0);
+            dup2(fds[1], STDOUT_FILENO);
+            execl("/bin/sh", "sh", "-c", cmd.c_str(), (char*)nullptr);
+            _exit(127);
+        }
+        close(fds[1]);
+
+        auto remaining = [&] {
+            return std::max<long>(0, std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now()).count());
+        };
+
         std::string result;
         result.reserve(8192);
+        std::array<char, 65536> buffer;
+        bool timed_out = false;
 
-        std::unique_ptr<FILE, int(*)(FILE*)> pipe(
-            popen(cmd.c_str(), "r"),
-            static_cast<int(*)(FILE*)>(pclose)
-        );
-        if (!pipe) return "";
-        while (fgets(buffer.data(), buffer.size(), pipe.get()) != nullptr) {
-            result += buffer.data();
+        for (;;) {
+            if (aborted()) {
+                timed_out = true;
+                break;
+            }
+            pollfd pfd{fds[0], POLLIN, 0};
+            int ready = poll(&pfd, 1, (int)std::min<long>(remaining(), 100));
+            if (ready < 0 && errno != EINTR) break;
+            if (ready > 0) {
+                ssize_t n = read(fds[0], buffer.data(), buffer.size());
+                if (n > 0) result.append(buffer.data(), n);
+                else if (n == 0 || errno != EINTR) break;
+            } else if (remaining() == 0) {
+                timed_out = true;
+                break;
+            }
+        }
+        close(fds[0]);
+
+        int wstatus = 0;
+        while (!timed_out && waitpid(pid, &wstatus, WNOHANG) == 0) {
+            if (remaining() == 0 || aborted()) timed_out = true;
+            else usleep(1000);
         }
+        if (timed_out) {
+            kill(-pid, SIGKILL);
+            waitpid(pid, &wstatus, 0);
+            return "";
+        }
+
+        if (status) *status = WIFEXITED(wstatus) ? WEXITSTATUS(wstatus) : -1;
+        return result;
+    }
+
+    // Runs a command (or the installed runner) and records its latency.
+    // Goes through the command class's circuit breaker: while it is open the
+    // command is not run, and then as when it times out or fails, the last
+    // good output of the same command is returned. `status` gets the exit
+    // status of a command that ran, -1 when it timed out or was not run.
+    static inline std::string exec(const std::string& cmd, int* status_out = nullptr) {
+        std::string key = commandKey(cmd);
+        CircuitBreaker& b = breaker();
+
+        std::string last;
+        if (status_out) *status_out = -1;
+        if (!b.allow(key)) {
+            stats::get("breaker:" + key.substr(5)).record(0);
+            b.rejected(key);
+            b.lastGood(cmd, last);
+            return last;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        int status = 0;
+        std::string result = runner() ? runner()(cmd, &status) : shell(cmd, &status);
+        if (status_out) *status_out = status;
+
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        stats::get(key).record(us, result.size());
+
+        // a job-scoped query legitimately fails for a job that just left
+        bool shared = key == "exec:squeue" || key == "exec:sinfo" || key == "exec:sacct" ||
+                      key == "exec:scontrol show node";
+        if (status < 0 || (status > 0 && result.empty() && shared)) {
+            b.failure(key);
+            return b.lastGood(cmd, last) ? last : result;
+        }
+
+        b.success(key, cmd, result);
         return result;
     }
 
+    // Runs a command that changes state (scancel). It bypasses the circuit
+    // breaker and is never answered with an old output, which would report
+    // work that was not done; `status` gets -1 when it timed out.
+    static inline std::string mutate(const std::string& cmd, int* status) {
+        auto start = std::chrono::steady_clock::now();
+        *status = 0;
+        std::string result = runner() ? runner()(cmd, status) : shell(cmd, status);
+
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        stats::get(commandKey(cmd)).record(us, result.size());
+        return result;
+    }
+
+    // The query class currently served from old data, for the footer.
+    static CircuitBreaker::Stale staleData() {
+        return breaker().stale();
+    }
+
+private:
+    static inline Runner& runner() {
+        static Runner r;
+        return r;
+    }
+
+    static inline std::atomic<bool>& aborted() {
+        static std::atomic<bool> flag{false};
+        return flag;
+    }
+
+    static inline CircuitBreaker& breaker() {
+        static CircuitBreaker b;
+        return b;
+    }
+
+    static inline SingleFlight<std::vector<Job>>& jobsFlight() {
+        static SingleFlight<std::vector<Job>> flight(FRESHNESS);
+        return flight;
+    }
+
+    static inline SingleFlight<DetailedJob>& detailsFlight() {
+        static SingleFlight<DetailedJob> flight(FRESHNESS);
+        return flight;
+    }
+
+    static inline SingleFlight<ClusterNodes>& nodesFlight() {
+        static SingleFlight<ClusterNodes> flight(FRESHNESS);
+        return flight;
+    }
+
+    static inline SingleFlight<std::vector<PartitionInfo>>& partitionsFlight() {
+        static SingleFlight<std::vector<PartitionInfo>> flight(FRESHNESS);
+        return flight;
+    }
+
+    // Answers a query from rsvd's snapshot when the daemon is running,
+    // otherwise runs `cmd` directly.
+    static inline std::string query(const std::string& request, const std::string& cmd) {
+        if (!runner()) {
+            static Histogram& rsvd_hist = stats::get("rsvd:query");
+            auto start = std::chrono::steady_clock::now();
+
+            std::string out;
+            if (rsvd::query(request, out)) {
+                auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - start).count();
+                rsvd_hist.record(us, out.size());
+                return out;
+            }
+        }
+        return exec(cmd);
+    }
+
+    // Sums every gpu entry of a GRES string, e.g. "gpu:a100:4(S:0-1),gpu:2" -> 6.
+    static inline int countGpus(const std::string& gres) {
+        int total = 0;
+        size_t pos = 0;
+        while ((pos = gres.find("gpu", pos)) != std::string::npos) {
+            size_t end = gres.find_first_of(",(", pos);
+            if (end == std::string::npos) end = gres.size();
+
+            size_t colon = gres.rfind(':', end);
+            if (colon != std::string::npos && colon >= pos) {
+                try { total += std::stoi(gres.substr(colon + 1, end - colon - 1)); } catch (...) {}
+            }
+
+            pos = gres.find(',', end);
+            if (pos == std::string::npos) break;
+        }
+        return total;
+    }
+
+    // Socket affinity of each GPU of a node's Gres, in index order, from the
+    // "(S:0-1)" of each entry: "gpu:a100:2(S:0),gpu:a100:2(S:1)" gives
+    // {0b01, 0b01, 0b10, 0b10}.
+    static inline std::vector<unsigned> gpuAffinity(const std::string& gres) {
+        std::vector<unsigned> affinity;
+        size_t pos = 0;
+        while ((pos = gres.find("gpu", pos)) != std::string::npos) {
+            size_t end = gres.find_first_of(",(", pos);
+            if (end == std::string::npos) end = gres.size();
+
+            int count = 0;
+            size_t colon = gres.rfind(':', end);
+            if (colon != std::string::npos && colon >= pos) {
+                try { count = std::stoi(gres.substr(colon + 1, end - colon - 1)); } catch (...) {}
+            }
+
+            unsigned mask = 0;
+            if (end < gres.size() && gres[end] == '(' && gres.compare(end + 1, 2, "S:") == 0) {
+                size_t close = gres.find(')', end);
+                for (int socket : parseCpuIds(gres.substr(end + 3, close == std::string::npos ? std::string::npos : close - end - 3))) {
+                    if (socket >= 0 && socket < 32) mask |= 1u << socket;
+                }
+                end = close == std::string::npos ? gres.size() : close;
+            }
+            affinity.insert(affinity.end(), std::max(0, count), mask);
+
+            pos = gres.find(',', end);
+            if (pos == std::string::npos) break;
+        }
+        return affinity;
+    }
+
+    static inline NodeState parseNodeState(const std::string& state) {
+        if (state.find("DRAIN") != std::string::npos) return NodeState::Drain;
+        if (state.find("DOWN") != std::string::npos ||
+            state.find("FAIL") != std::string::npos ||
+            (!state.empty() && state.back() == '*')) return NodeState::Down;
+        if (startsWith(state, "IDLE")) return NodeState::Idle;
+        if (startsWith(state, "MIX")) return NodeState::Mixed;
+        if (startsWith(state, "ALLOC")) return NodeState::Allocated;
+        return NodeState::Other;
+    }
+
+    static inline bool startsWith(const std::string& s, const std::string& prefix) {
+        return s.size() >= prefix.size() && s.compare(0, prefix.size(), prefix) == 0;
+    }
+
+public:
+    // Job ids go into shell command lines and may come from rsvd, so only
+    // the characters of "123", "123_4", "123_[0-9]" and "123+1" pass.
+    static inline bool validJobId(const std::string& id) {
+        return !id.empty() && id.find_first_not_of("0123456789_+[]-") == std::string::npos;
+    }
+
+    // Same for node lists such as "node[01-04],gpu07".
+    static inline bool validNodeList(const std::string& nodes) {
+        return !nodes.empty() && std::all_of(nodes.begin(), nodes.end(), [](char c) {
+            return std::isalnum((unsigned char)c) || std::strchr("_.,[]-", c);
+        });
+    }
+
+    // Number of hosts in a hostlist such as "node[01-04,07],gpu1", without
+    // asking scontrol.
+    static inline int countHosts(const std::string& list) {
+        int total = 0, host = 1;
+        bool named = false;
+        for (size_t i = 0; i < list.size(); ++i) {
+            if (list[i] == '[') {
+                size_t close = list.find(']', i);
+                if (close == std::string::npos) break;
+                int n = 0;
+                std::istringstream ranges(list.substr(i + 1, close - i - 1));
+                for (std::string r; std::getline(ranges, r, ','); ) {
+                    size_t dash = r.find('-');
+                    n += dash == std::string::npos ? 1 : std::max(1, std::atoi(r.c_str() + dash + 1) - std::atoi(r.c_str()) + 1);
+                }
+                host *= std::max(1, n);
+                named = true;
+                i = close;
+            } else if (list[i] == ',') {
+                if (named) total += host;
+                host = 1;
+                named = false;
+            } else {
+                named = true;
+            }
+        }
+        return named ? total + host : total;
+    }
+
+    // Host names of a hostlist such as "node[01-04,07],gpu1", in order and
+    // with their zero padding, expanded here rather than by a scontrol fork.
+    static inline std::vector<std::string> hostNames(const std::string& list) {
+        std::vector<std::string> names;
+        for (size_t start = 0; start < list.size(); ) {
+            // a comma between brackets separates ranges, not hosts
+            size_t end = start;
+            for (int depth = 0; end < list.size() && (depth > 0 || list[end] != ','); ++end) {
+                if (list[end] == '[') ++depth;
+                else if (list[end] == ']') depth = std::max(0, depth - 1);
+            }
+
+            std::vector<std::string> hosts = {""};
+            bool valid = end > start;
+            for (size_t i = start; valid && i < end; ++i) {
+                if (list[i] != '[') {
+                    for (auto& host : hosts) host += list[i];
+                    continue;
+                }
+                size_t close = list.find(']', i);
+                if (close == std::string::npos || close > end) {
+                    valid = false;
+                    break;
+                }
+
+                std::vector<std::string> numbers;
+                std::istringstream ranges(list.substr(i + 1, close - i - 1));
+                for (std::string r; std::getline(ranges, r, ','); ) {
+                    size_t dash = r.find('-');
+                    std::string lo = r.substr(0, dash);
+                    int from = std::atoi(lo.c_str());
+                    int to = dash == std::string::npos ? from : std::max(from, std::atoi(r.c_str() + dash + 1));
+                    for (int n = from; n <= to; ++n) {
+                        std::string number = std::to_string(n);
+                        if (number.size() < lo.size()) number.insert(0, lo.size() - number.size(), '0');
+                        numbers.push_back(number);
+                    }
+                }
+
+                std::vector<std::string> next;
+                next.reserve(hosts.size() * numbers.size());
+                for (const auto& host : hosts) {
+                    for (const auto& number : numbers) next.push_back(host + number);
+                }
+                hosts.swap(next);
+                i = close;
+            }
+            if (valid) names.insert(names.end(), hosts.begin(), hosts.end());
+            start = end + 1;
+        }
+        return names;
+    }
+
+    // Reads "gres/gpu=N" out of a TRES string such as "cpu=64,mem=250G,gres/gpu=4".
+    static inline int tresGpus(const std::string& tres) {
+        size_t pos = tres.find("gres/gpu=");
+        if (pos == std::string::npos) return -1;
+        try { return std::stoi(tres.substr(pos + 9)); } catch (...) { return -1; }
+    }
+
     static inline std::vector<int> parseCpuIds(const std::string& cpu_ids_str) {
         std::vector<int> cpu_ids;
         static std::regex re(R"((\d+)-(\d+)|(\d+))");
@@ -108,179 +723,596 @@ private:
         return cpu_ids;
     }
 
-    static inline std::unordered_map<std::string, std::pair<int,int>> getAllNodeInfo(const std::string& node_str) {
-        std::unordered_map<std::string, std::pair<int,int>> info;
-        if (node_str.empty()) return info;
+    // Parses Slurm durations: "[DD-[HH:]]MM:SS[.mmm]" or "HH:MM:SS".
+    static inline double parseDuration(const std::string& str) {
+        if (str.empty()) return 0;
+
+        double days = 0;
+        std::string rest = str;
+        size_t dash = rest.find('-');
+        if (dash != std::string::npos) {
+            try { days = std::stod(rest.substr(0, dash)); } catch (...) {}
+            rest = rest.substr(dash + 1);
+        }
+
+        std::vector<double> parts;
+        std::istringstream iss(rest);
+        for (std::string part; std::getline(iss, part, ':'); ) {
+            try { parts.push_back(std::stod(part)); } catch (...) { parts.push_back(0); }
+        }
+
+        double seconds = 0;
+        for (double p : parts) seconds = seconds * 60 + p;
+        // after a day prefix the fields are HH[:MM[:SS]], not MM:SS
+        if (dash != std::string::npos && parts.size() == 2) seconds *= 60;
+        if (dash != std::string::npos && parts.size() == 1) seconds *= 3600;
+
+        return days * 86400 + seconds;
+    }
+
+    // Parses Slurm memory sizes such as "1234K", "3.5G" or "512" (bytes).
+    static inline long long parseMemory(const std::string& str) {
+        if (str.empty()) return 0;
+
+        double value = 0;
+        size_t used = 0;
+        try { value = std::stod(str, &used); } catch (...) { return 0; }
+
+        double scale = 1;
+        if (used < str.size()) {
+            switch (std::toupper(str[used])) {
+                case 'K': scale = 1024.0; break;
+                case 'M': scale = 1024.0 * 1024; break;
+                case 'G': scale = 1024.0 * 1024 * 1024; break;
+                case 'T': scale = 1024.0 * 1024 * 1024 * 1024; break;
+                default: break;
+            }
+        }
+        return (long long)(value * scale);
+    }
+
+    // Megabytes as Slurm counts them, e.g. 256000 -> "250.0G".
+    static inline std::string formatMemory(long long megabytes) {
+        char buf[32];
+        double mb = (double)megabytes;
+        if (mb >= 1024.0 * 1024) std::snprintf(buf, sizeof(buf), "%.1fT", mb / (1024.0 * 1024));
+        else if (mb >= 1024) std::snprintf(buf, sizeof(buf), "%.1fG", mb / 1024);
+        else std::snprintf(buf, sizeof(buf), "%lldM", megabytes);
+        return buf;
+    }
+
+    static inline std::unordered_map<std::string, NodeShape> getAllNodeInfo(const std::string& node_str) {
+        std::unordered_map<std::string, NodeShape> info;
+        if (!validNodeList(node_str)) return info;
 
         std::string out = exec("scontrol show node " + node_str);
         if (out.empty()) return info;
 
+        static Histogram& parse_hist = stats::get("parse:scontrol show node");
+        stats::Scope scope(parse_hist);
+
         std::istringstream iss(out);
         std::string line;
 
         static std::regex name_re(R"(NodeName=([^\s]+))");
         static std::regex cpu_re(R"(CPUTot=(\d+))");
-        static std::regex gpu_re(R"(Gres=gpu:[^:]*:(\d+))");
+        static std::regex gres_re(R"((?:^|\s)Gres=([^\s]+))");
+        static std::regex sockets_re(R"((?:^|\s)Sockets=(\d+))");
+        static std::regex cores_re(R"(CoresPerSocket=(\d+))");
+        static std::regex threads_re(R"(ThreadsPerCore=(\d+))");
+        static std::regex real_mem_re(R"(RealMemory=(\d+))");
+        static std::regex alloc_mem_re(R"(AllocMem=(\d+))");
+        static std::regex free_mem_re(R"(FreeMem=(\d+))");
 
         std::string current_node;
-        int total_cores = 0;
-        int total_gpus = 0;
+        NodeShape shape;
 
         for (std::string line; std::getline(iss, line); ) {
             std::smatch m;
 
             if (std::regex_search(line, m, name_re)) {
                 if (!current_node.empty()) {
-                    info[current_node] = {total_cores, total_gpus};
+                    info[current_node] = shape;
                 }
                 current_node = m[1];
-                total_cores = 0;
-                total_gpus = 0;
+                shape = NodeShape();
             }
 
             if (std::regex_search(line, m, cpu_re)) {
-                total_cores = std::stoi(m[1]);
+                shape.cores = std::stoi(m[1]);
+            }
+            if (std::regex_search(line, m, gres_re)) {
+                shape.gpus = countGpus(m[1]);
+                shape.gpu_affinity = gpuAffinity(m[1]);
+            }
+            if (std::regex_search(line, m, sockets_re)) {
+                shape.sockets = std::max(1, std::stoi(m[1]));
+            }
+            if (std::regex_search(line, m, cores_re)) {
+                shape.cores_per_socket = std::stoi(m[1]);
+            }
+            if (std::regex_search(line, m, threads_re)) {
+                shape.threads_per_core = std::max(1, std::stoi(m[1]));
+            }
+            if (std::regex_search(line, m, real_mem_re)) {
+                shape.real_memory_mb = std::stoll(m[1]);
+            }
+            if (std::regex_search(line, m, alloc_mem_re)) {
+                shape.alloc_memory_mb = std::stoll(m[1]);
             }
-            if (std::regex_search(line, m, gpu_re)) {
-                total_gpus = std::stoi(m[1]);
+            if (std::regex_search(line, m, free_mem_re)) {
+                shape.free_memory_mb = std::stoll(m[1]);
             }
         }
 
         if (!current_node.empty()) {
-            info[current_node] = {total_cores, total_gpus};
+            info[current_node] = shape;
         }
 
         return info;
     }
 
 
-    static inline std::vector<std::string> expandNodelist(const std::string& node_list) {
-        std::string cmd = "scontrol show hostnames " + node_list + " 2>/dev/null";
-        std::string out = exec(cmd);
-        std::vector<std::string> nodes;
-        std::istringstream iss(out);
-        std::string line;
-        while (std::getline(iss, line)) {
-            if (!line.empty()) nodes.push_back(line);
-        }
-        return nodes;
+    // Drops every coalesced result so the next query of each kind runs again.
+    static void invalidateCaches() {
+        jobsFlight().invalidateAll();
+        detailsFlight().invalidateAll();
+        nodesFlight().invalidateAll();
+        partitionsFlight().invalidateAll();
     }
 
-public:
     static std::vector<Job> getUserJobs() {
-        std::vector<Job> jobs;
+        return jobsFlight().run("squeue:user", fetchUserJobs);
+    }
+
+    // Every task of one array, expanded; only called when its row is opened.
+    static std::vector<Job> getArrayTasks(const std::string& array_id) {
+        return jobsFlight().run("squeue:array:" + array_id, [&] { return fetchArrayTasks(array_id); });
+    }
+
+    static DetailedJob getJobDetails(const std::string& job_id) {
+        return detailsFlight().run(job_id, [&] { return fetchJobDetails(job_id); });
+    }
+
+    // Tiles of the pinned jobs, in the order of `ids`, from one squeue over
+    // the user's jobs and one scontrol over the nodes they hold, however
+    // many jobs are pinned; node lists are expanded in-process. squeue only
+    // reports a job's CPU count, so its cores are spread evenly over its
+    // nodes. `answered` is false when squeue gave no answer, and then no
+    // tile says whether it is listed.
+    static std::vector<JobTile> getJobTiles(const std::vector<std::string>& ids, bool* answered = nullptr) {
+        if (answered) *answered = false;
+        if (ids.empty()) return {};
 
         const char* user = std::getenv("USER");
         if (!user) user = "unknown";
 
-        std::string cmd = "squeue -u " + std::string(user) + " -o \"%i %j\" --noheader";
+        // -r lists pending array tasks one by one, so a pinned 123_7 is not
+        // folded into 123_[5-10]; the header tells an empty queue from no answer
+        std::string out = exec("squeue -r -u " + std::string(user) + " -o \"" + TILES_FORMAT + "\" 2>/dev/null");
+        if (out.compare(0, 5, "JOBID") != 0) return {};
+        if (answered) *answered = true;
 
-        std::array<char, 256> buffer;
-        std::unique_ptr<FILE, int(*)(FILE*)> pipe(
-            popen(cmd.c_str(), "r"),
-            static_cast<int(*)(FILE*)>(pclose)
-        );
+        std::set<std::string> wanted(ids.begin(), ids.end());
+        std::map<std::string, JobTile> found;
+        std::map<std::string, std::string> node_lists;
 
-        if (!pipe) {
-            std::cerr << "Failed to run squeue command\n";
-            return jobs;
+        std::istringstream iss(out);
+        for (std::string line; std::getline(iss, line); ) {
+            // '|' separated: the node list of a pending job is empty
+            std::vector<std::string> fields;
+            std::istringstream lss(line);
+            for (std::string field; std::getline(lss, field, '|'); ) fields.push_back(field);
+            if (fields.size() < 10 || !wanted.count(fields[0])) continue;
+
+            JobTile tile;
+            tile.id = fields[0];
+            tile.state = fields[1];
+            tile.partition = fields[2];
+            tile.elapsed = fields[3];
+            tile.limit = fields[4];
+            std::string nodes = fields[5], cpus = fields[6], gres = fields[7], node_list = fields[8];
+            tile.name = fields[9];
+
+            tile.listed = true;
+            tile.nodes = std::atoi(nodes.c_str());
+            tile.cpus = std::atoi(cpus.c_str());
+            int gpus_per_node = tresGpus(gres);
+            if (gpus_per_node < 0) gpus_per_node = countGpus(gres);
+            tile.gpus = gpus_per_node * std::max(1, tile.nodes);
+
+            if (tile.state == "RUNNING" && !node_list.empty() && node_list != "(null)") {
+                node_lists[tile.id] = node_list;
+            }
+            found[tile.id] = tile;
         }
 
-        while (fgets(buffer.data(), buffer.size(), pipe.get()) != nullptr) {
-            std::string line = buffer.data();
-            if (line.empty()) continue;
+        std::string all_nodes;
+        for (const auto& [id, list] : node_lists) all_nodes += (all_nodes.empty() ? "" : ",") + list;
+        auto sizes = getAllNodeInfo(all_nodes);
+
+        for (const auto& [id, list] : node_lists) {
+            JobTile& tile = found[id];
+            auto names = hostNames(list);
+            int per_node = tile.cpus / std::max<size_t>(1, names.size());
+            int extra = tile.cpus % std::max<size_t>(1, names.size());
+
+            for (size_t i = 0; i < names.size(); ++i) {
+                JobTile::Node node;
+                node.name = names[i];
+                node.cores = per_node + ((int)i < extra ? 1 : 0);
+                node.gpus = tile.gpus / std::max<size_t>(1, names.size());
+                auto size = sizes.find(node.name);
+                if (size != sizes.end()) {
+                    node.total_cores = size->second.cores;
+                    node.total_gpus = size->second.gpus;
+                }
+                tile.allocation.push_back(node);
+            }
+        }
 
-            std::istringstream iss(line);
+        std::vector<JobTile> tiles;
+        for (const auto& id : ids) {
+            auto it = found.find(id);
+            if (it != found.end()) {
+                tiles.push_back(it->second);
+            } else {
+                JobTile gone;
+                gone.id = id;
+                tiles.push_back(gone);
+            }
+        }
+        return tiles;
+    }
+
+    // The other jobs on each node of `job`, in node_allocations order: one
+    // squeue over all of its nodes for the tenants and one scontrol for the
+    // nodes' allocated cores and load, whatever the number of nodes.
+    static std::vector<NodeTenancy> getNodeTenancy(const DetailedJob& job) {
+        std::vector<NodeTenancy> tenancy;
+        if (!validNodeList(job.node_list)) return tenancy;
+
+        std::unordered_map<std::string, size_t> index;
+        for (const auto& node : job.node_allocations) {
+            index.emplace(node.node_name, tenancy.size());
+            NodeTenancy t;
+            t.node_name = node.node_name;
+            t.total_cores = node.total_cores;
+            tenancy.push_back(t);
+        }
+
+        std::string out = exec("squeue -w " + job.node_list + " -t RUNNING -h -o \"%A|%i|%u|%j|%C|%N\" 2>/dev/null");
+        std::istringstream iss(out);
+        for (std::string line; std::getline(iss, line); ) {
+            std::vector<std::string> fields;
+            std::istringstream lss(line);
+            for (std::string field; std::getline(lss, field, '|'); ) fields.push_back(field);
+            if (fields.size() < 6 || fields[0] == job.id || fields[1] == job.id) continue;
+
+            auto nodes = hostNames(fields[5]);
+            if (nodes.empty()) continue;
+            int cpus = std::atoi(fields[4].c_str());
+
+            for (size_t i = 0; i < nodes.size(); ++i) {
+                auto it = index.find(nodes[i]);
+                if (it == index.end()) continue;
+
+                Tenant tenant;
+                tenant.job_id = fields[1];
+                tenant.user = fields[2];
+                tenant.name = fields[3];
+                tenant.cpus = cpus / (int)nodes.size() + ((int)i < cpus % (int)nodes.size() ? 1 : 0);
+                tenancy[it->second].tenants.push_back(tenant);
+            }
+        }
+
+        // Key=Value pairs split by hand, as for the node inventory
+        out = exec("scontrol show node -o " + job.node_list);
+        std::istringstream nss(out);
+        for (std::string line; std::getline(nss, line); ) {
+            std::string name, cpu_alloc, cpu_total, cpu_load;
+            size_t pos = 0;
+            while (pos < line.size()) {
+                size_t end = line.find(' ', pos);
+                if (end == std::string::npos) end = line.size();
+
+                size_t eq = line.find('=', pos);
+                if (eq != std::string::npos && eq < end) {
+                    std::string key = line.substr(pos, eq - pos);
+                    if (key == "NodeName") name = line.substr(eq + 1, end - eq - 1);
+                    else if (key == "CPUAlloc") cpu_alloc = line.substr(eq + 1, end - eq - 1);
+                    else if (key == "CPUTot") cpu_total = line.substr(eq + 1, end - eq - 1);
+                    else if (key == "CPULoad") cpu_load = line.substr(eq + 1, end - eq - 1);
+                }
+                pos = end + 1;
+            }
+
+            auto it = index.find(name);
+            if (it == index.end()) continue;
+            NodeTenancy& t = tenancy[it->second];
+            t.cpu_alloc = std::atoi(cpu_alloc.c_str());
+            if (!cpu_total.empty()) t.total_cores = std::atoi(cpu_total.c_str());
+            if (!cpu_load.empty() && std::isdigit((unsigned char)cpu_load[0])) t.cpu_load = std::atof(cpu_load.c_str());
+        }
+
+        for (auto& t : tenancy) {
+            std::stable_sort(t.tenants.begin(), t.tenants.end(), [](const Tenant& a, const Tenant& b) { return a.cpus > b.cpus; });
+        }
+        return tenancy;
+    }
+
+    static ClusterNodes getClusterNodes() {
+        return nodesFlight().run("scontrol:nodes", fetchClusterNodes);
+    }
+
+    static std::vector<PartitionInfo> getPartitions() {
+        return partitionsFlight().run("sinfo:partitions", fetchPartitions);
+    }
+
+private:
+    static std::vector<Job> fetchUserJobs() {
+        std::vector<Job> jobs;
+
+        const char* user = std::getenv("USER");
+        if (!user) user = "unknown";
+
+        std::string cmd = "squeue -u " + std::string(user) + " -o \"" + JOBS_FORMAT + "\" --noheader";
+        std::string out = query("jobs", cmd);
+
+        static Histogram& parse_hist = stats::get("parse:squeue");
+        stats::Scope scope(parse_hist);
+
+        // array job id -> its row in `jobs` and the task intervals seen so far
+        std::map<std::string, size_t> arrays;
+        std::map<std::string, std::vector<std::pair<long, long>>> intervals;
+
+        std::istringstream iss(out);
+        for (std::string line; std::getline(iss, line); ) {
             Job job;
-            iss >> job.id >> job.name;
-            job.entry_name = (job.name + " (" + job.id + ")");
+            std::string spec;
+            if (!parseJobLine(line, job, spec)) continue;
 
-            if (!job.id.empty() && !job.name.empty()) {
+            if (job.array_id.empty()) {
                 jobs.push_back(job);
+                continue;
+            }
+
+            auto it = arrays.find(job.array_id);
+            if (it == arrays.end()) {
+                Job row;
+                row.id = job.array_id;
+                row.name = job.name;
+                row.array_id = job.array_id;
+                row.entry_name = job.name + " (" + job.array_id + ")";
+                it = arrays.emplace(job.array_id, jobs.size()).first;
+                jobs.push_back(row);
+            }
+
+            Job& row = jobs[it->second];
+            int count = parseTaskSpec(spec, intervals[job.array_id]);
+            row.task_count += count;
+            row.task_states[job.state] += count;
+            if (job.state == "RUNNING") {
+                row.cpus += job.cpus;
+                row.gpus += job.gpus;
+            } else if (job.state == "PENDING") {
+                row.reason = job.reason;
+            }
+
+            // a running task shows best what the array is doing
+            if (row.detail_id.empty() || (job.state == "RUNNING" && row.state != "RUNNING")) {
+                row.state = job.state;
+                row.detail_id = job.id.find('[') == std::string::npos
+                    ? job.id
+                    : job.array_id + "_" + std::to_string(intervals[job.array_id].back().first);
             }
         }
 
+        for (const auto& [array_id, index] : arrays) {
+            auto& ranges = intervals[array_id];
+            std::sort(ranges.begin(), ranges.end());
+
+            std::string tasks;
+            for (size_t i = 0; i < ranges.size(); ) {
+                long lo = ranges[i].first, hi = ranges[i].second;
+                for (++i; i < ranges.size() && ranges[i].first <= hi + 1; ++i) hi = std::max(hi, ranges[i].second);
+
+                if (!tasks.empty()) tasks += ",";
+                tasks += lo == hi ? std::to_string(lo) : std::to_string(lo) + "-" + std::to_string(hi);
+            }
+            jobs[index].tasks = tasks.empty() ? "?" : tasks;
+        }
+
         return jobs;
     }
 
-    static DetailedJob getJobDetails(const std::string& job_id) {
-        DetailedJob job;
+    static std::vector<Job> fetchArrayTasks(const std::string& array_id) {
+        std::vector<Job> tasks;
 
-        std::string sctrl = exec("scontrol show jobid -dd " + job_id);
-        if (sctrl.empty()) return job;
+        if (!validJobId(array_id)) return tasks;
+        std::string out = exec("squeue -r -j " + array_id + " -o \"" + JOBS_FORMAT + "\" --noheader 2>/dev/null");
+
+        static Histogram& parse_hist = stats::get("parse:squeue");
+        stats::Scope scope(parse_hist);
 
-        std::regex field_re(R"((\w+)=([^\s]+))");
-        for (std::sregex_iterator it(sctrl.begin(), sctrl.end(), field_re), end; it != end; ++it) {
-            std::string key = (*it)[1];
-            std::string val = (*it)[2];
-            if (key == "JobId") job.id = val;
-            else if (key == "JobName") job.name = val;
-            else if (key == "SubmitTime") job.submitTime = val;
-            else if (key == "NumNodes") job.nodes = std::stoi(val);
-            else if (key == "TimeLimit") job.maxTime = val;
-            else if (key == "Partition") job.partition = val;
-            else if (key == "JobState") job.status = val;
-            else if (key == "Features") job.constraints = val;
-            else if (key == "RunTime") job.elapsedTime = val;
-            else if (key == "Reason") job.reason = val;
+        std::istringstream iss(out);
+        for (std::string line; std::getline(iss, line); ) {
+            Job job;
+            std::string spec;
+            if (parseJobLine(line, job, spec)) tasks.push_back(job);
         }
 
-        static std::regex alloc_re(
-            R"(^\s*Nodes=([^\s]+)\s+CPU_IDs=([^\s]+).*?(?:GRES=([^\s]+))?)",
-            std::regex_constants::multiline
-        );
+        return tasks;
+    }
+
+    // One JOBS_FORMAT line; `spec` receives the array task field (%K).
+    static bool parseJobLine(const std::string& line, Job& job, std::string& spec) {
+        std::istringstream lss(line);
+        std::string array_job_id, nodes, cpus, gres;
+        lss >> job.id >> array_job_id >> spec >> job.state >> nodes >> cpus >> gres >> job.reason;
+        std::getline(lss >> std::ws, job.name);
+
+        if (job.id.empty() || job.name.empty()) return false;
+
+        job.cpus = std::atoi(cpus.c_str());
+        // %b is per node: "gres/gpu:4", "gres:gpu:a100:2" or "N/A"
+        int gpus_per_node = tresGpus(gres);
+        if (gpus_per_node < 0) gpus_per_node = countGpus(gres);
+        job.gpus = gpus_per_node * std::max(1, std::atoi(nodes.c_str()));
+
+        if (spec != "N/A" && !spec.empty()) job.array_id = array_job_id;
+        job.detail_id = job.id;
+        job.entry_name = job.name + " (" + job.id + ")";
+        return true;
+    }
 
-        std::sregex_iterator it(sctrl.begin(), sctrl.end(), alloc_re);
-        std::sregex_iterator end;
+    // Log path of another task of the same array: expands the pattern for
+    // task `id`, or rewrites "<array>_<task>" when scontrol already expanded
+    // it. Empty when the path depends on the task's own job id.
+    static std::string taskLogPath(const std::string& pattern, LogContext ctx, long id) {
+        std::string task = std::to_string(id);
+        if (pattern.find('%') != std::string::npos) {
+            if (pattern.find("%j") != std::string::npos || pattern.find("%J") != std::string::npos) return "";
+            ctx.array_task_id = task;
+            return expandSlurmPath(pattern, ctx);
+        }
 
-        for (; it != end; ++it) {
-            std::string node_str = (*it)[1].str();
-            std::string cpu_str  = (*it)[2].str();
-            std::string gres_str = it->size() > 3 ? (*it)[3].str() : "";
+        std::string from = ctx.array_job_id + "_" + ctx.array_task_id;
+        size_t pos = pattern.rfind(from);
+        if (pos == std::string::npos) return "";
+        return pattern.substr(0, pos) + ctx.array_job_id + "_" + task + pattern.substr(pos + from.size());
+    }
 
-            auto nodes = expandNodelist(node_str);
-            auto cpu_ids = parseCpuIds(cpu_str);
+    // Counts the tasks in a squeue task field ("7", "8-9999", "[1,3-5%2]",
+    // "0-20:2") and appends its index ranges to `ranges`.
+    static int parseTaskSpec(std::string spec, std::vector<std::pair<long, long>>& ranges) {
+        spec.erase(std::remove_if(spec.begin(), spec.end(), [](char c) { return c == '[' || c == ']'; }), spec.end());
+        size_t throttle = spec.find('%');
+        if (throttle != std::string::npos) spec.erase(throttle);
+
+        int count = 0;
+        std::istringstream iss(spec);
+        for (std::string part; std::getline(iss, part, ','); ) {
+            long step = 1;
+            size_t colon = part.find(':');
+            if (colon != std::string::npos) {
+                step = std::max(1L, std::atol(part.c_str() + colon + 1));
+                part.erase(colon);
+            }
 
-            size_t missing_cpus = cpu_ids.size() % nodes.size();
-            int cpus_per_node = cpu_ids.size() / nodes.size();
+            size_t dash = part.find('-');
+            long lo = std::atol(part.c_str());
+            long hi = dash == std::string::npos ? lo : std::atol(part.c_str() + dash + 1);
+            if (hi < lo) continue;
+
+            ranges.emplace_back(lo, hi);
+            count += (hi - lo) / step + 1;
+        }
+        return count;
+    }
 
-            int allocated_gpus = 0;
-            if (!gres_str.empty()) {
-                static std::regex gpunum(R"(gpu:[^:]*:(\d+))");
-                std::smatch gm;
-                if (std::regex_search(gres_str, gm, gpunum))
-                    allocated_gpus = std::stoi(gm[1].str());
+    static DetailedJob fetchJobDetails(const std::string& job_id) {
+        DetailedJob job;
+
+        if (!validJobId(job_id)) return job;
+        std::string sctrl = exec("scontrol show jobid -dd " + job_id);
+        if (sctrl.empty()) return job;
+
+        // one allocation line: identical nodes share it
+        struct Allocation {
+            std::string node_str;
+            std::vector<int> cpu_ids;
+            long long mem_mb = 0;
+            int gpus = 0;
+            std::vector<int> gpu_ids;
+        };
+        std::vector<Allocation> allocations;
+
+        // parse time only: the scontrol calls below are timed as commands
+        {
+            static Histogram& parse_hist = stats::get("parse:scontrol show jobid");
+            stats::Scope scope(parse_hist);
+
+            std::regex field_re(R"((\w+)=([^\s]+))");
+            for (std::sregex_iterator it(sctrl.begin(), sctrl.end(), field_re), end; it != end; ++it) {
+                std::string key = (*it)[1];
+                std::string val = (*it)[2];
+                if (key == "JobId") job.id = val;
+                else if (key == "JobName") job.name = val;
+                else if (key == "SubmitTime") job.submitTime = val;
+                else if (key == "NumNodes") job.nodes = std::stoi(val);
+                else if (key == "TimeLimit") job.maxTime = val;
+                else if (key == "Partition") job.partition = val;
+                else if (key == "JobState") job.status = val;
+                else if (key == "Features") job.constraints = val;
+                else if (key == "RunTime") job.elapsedTime = val;
+                else if (key == "Reason") job.reason = val;
             }
 
-            job.cpus = cpu_ids.size();
-            job.gpus = allocated_gpus;
+            static std::regex alloc_re(
+                R"(^\s*Nodes=([^\s]+)\s+CPU_IDs=([^\s]+)(?:.*?\sMem=(\d+))?(?:.*?GRES=([^\s]+))?)",
+                std::regex_constants::multiline
+            );
+
+            for (std::sregex_iterator it(sctrl.begin(), sctrl.end(), alloc_re), end; it != end; ++it) {
+                Allocation a;
+                a.node_str = (*it)[1].str();
+                a.cpu_ids = parseCpuIds((*it)[2].str());
+                a.mem_mb = (*it)[3].matched ? std::stoll((*it)[3].str()) : 0;
+                std::string gres_str = it->size() > 4 ? (*it)[4].str() : "";
+
+                // GRES of an allocation line is per node: "gpu:2(IDX:0-1)" or
+                // "gpu:a100:2(IDX:0-1)"
+                if (!gres_str.empty()) {
+                    static std::regex gpunum(R"(gpu:(?:[^:(,]*:)?(\d+))");
+                    static std::regex gpuidx(R"(IDX:([^)]+))");
+                    std::smatch gm;
+                    if (std::regex_search(gres_str, gm, gpunum))
+                        a.gpus = std::stoi(gm[1].str());
+                    if (std::regex_search(gres_str, gm, gpuidx))
+                        a.gpu_ids = parseCpuIds(gm[1].str());
+                }
 
-            std::unordered_map<std::string, std::pair<int,int>> nodes_info = getAllNodeInfo(node_str);         
+                job.node_list += (job.node_list.empty() ? "" : ",") + a.node_str;
+                allocations.push_back(std::move(a));
+            }
+        }
+
+        std::unordered_map<std::string, NodeShape> nodes_info = getAllNodeInfo(job.node_list);
+
+        for (const auto& a : allocations) {
+            auto nodes = hostNames(a.node_str);
 
-            int cpu_index = 0;
-            for (size_t group_index = 0; group_index < nodes.size(); ++group_index) {
+            // scontrol groups identical nodes on one line, and like GRES its
+            // CPU_IDs then hold for each of them
+            job.cpus += a.cpu_ids.size() * nodes.size();
+            job.gpus += a.gpus * nodes.size();
+
+            for (const auto& name : nodes) {
                 NodeAllocation na;
-                na.node_name = nodes[group_index];
+                na.node_name = name;
 
                 auto it = nodes_info.find(na.node_name);
 
                 if (it != nodes_info.end()) {
-                    na.total_cores = it->second.first;
-                    na.total_gpus  = it->second.second;
+                    na.total_cores = it->second.cores;
+                    na.total_gpus  = it->second.gpus;
+                    na.sockets = it->second.sockets;
+                    na.cores_per_socket = it->second.cores_per_socket;
+                    na.threads_per_core = it->second.threads_per_core;
+                    na.gpu_affinity = it->second.gpu_affinity;
+                    na.real_memory_mb = it->second.real_memory_mb;
+                    na.alloc_memory_mb = it->second.alloc_memory_mb;
+                    na.free_memory_mb = it->second.free_memory_mb;
                 } else {
                     na.total_cores = 0;
                     na.total_gpus  = 0;
                 }
 
-                na.allocated_gpus = allocated_gpus / nodes.size();
-
-                for (int i = 0; i < cpus_per_node; ++i) {
-                    na.allocated_cores.push_back(cpu_ids[cpu_index++]);
-                }
-
-                if (group_index < missing_cpus) {
-                    na.allocated_cores.push_back(cpu_ids[cpu_index++]);
-                }
+                na.allocated_gpus = a.gpus;
+                na.gpu_ids = a.gpu_ids;
+                na.mem_mb = a.mem_mb;
+                na.allocated_cores = a.cpu_ids;
 
                 job.node_allocations.push_back(std::move(na));
             }
@@ -289,17 +1321,182 @@ public:
         return job;
     }
 
-    static bool cancelJob(const std::string& job_id) {
-        std::string cmd = "scancel " + job_id + " 2>&1";
-        std::string result = exec(cmd);
-        return result.empty() || result.find("error") == std::string::npos;
+    // One `scontrol show node -o` call for the whole cluster. Each node is a
+    // single line of space separated Key=Value pairs, split by hand since a
+    // regex per field is far too slow for thousands of nodes.
+    static ClusterNodes fetchClusterNodes() {
+        ClusterNodes cluster;
+
+        std::string out = query("nodes", NODES_COMMAND);
+        if (out.empty()) return cluster;
+
+        static Histogram& parse_hist = stats::get("parse:node inventory");
+        stats::Scope scope(parse_hist);
+
+        size_t node_count = std::count(out.begin(), out.end(), '\n');
+        cluster.names.reserve(node_count);
+        cluster.partitions.reserve(node_count);
+        cluster.cpu_alloc.reserve(node_count);
+        cluster.cpu_total.reserve(node_count);
+        cluster.gpu_used.reserve(node_count);
+        cluster.gpu_total.reserve(node_count);
+        cluster.mem_total.reserve(node_count);
+        cluster.mem_alloc.reserve(node_count);
+        cluster.mem_free.reserve(node_count);
+        cluster.state.reserve(node_count);
+
+        std::istringstream iss(out);
+        for (std::string line; std::getline(iss, line); ) {
+            std::string name, partitions, state, gres, alloc_tres, cfg_tres;
+            int cpu_alloc = 0, cpu_total = 0;
+            long long mem_total = 0, mem_alloc = 0, mem_free = -1;
+
+            size_t pos = 0;
+            while (pos < line.size()) {
+                size_t end = line.find(' ', pos);
+                if (end == std::string::npos) end = line.size();
+
+                size_t eq = line.find('=', pos);
+                if (eq != std::string::npos && eq < end) {
+                    std::string key = line.substr(pos, eq - pos);
+                    std::string val = line.substr(eq + 1, end - eq - 1);
+
+                    if (key == "NodeName") name = val;
+                    else if (key == "CPUAlloc") { try { cpu_alloc = std::stoi(val); } catch (...) {} }
+                    else if (key == "CPUTot") { try { cpu_total = std::stoi(val); } catch (...) {} }
+                    else if (key == "State") state = val;
+                    else if (key == "Partitions") partitions = val;
+                    else if (key == "Gres") gres = val;
+                    else if (key == "AllocTRES") alloc_tres = val;
+                    else if (key == "CfgTRES") cfg_tres = val;
+                    else if (key == "RealMemory") { try { mem_total = std::stoll(val); } catch (...) {} }
+                    else if (key == "AllocMem") { try { mem_alloc = std::stoll(val); } catch (...) {} }
+                    else if (key == "FreeMem") { try { mem_free = std::stoll(val); } catch (...) {} }
+                }
+                pos = end + 1;
+            }
+
+            if (name.empty()) continue;
+
+            int gpu_total = tresGpus(cfg_tres);
+            if (gpu_total < 0) gpu_total = countGpus(gres);
+            int gpu_used = std::max(0, tresGpus(alloc_tres));
+
+            cluster.names.push_back(std::move(name));
+            cluster.partitions.push_back(std::move(partitions));
+            cluster.cpu_alloc.push_back(cpu_alloc);
+            cluster.cpu_total.push_back(cpu_total);
+            cluster.gpu_used.push_back(gpu_used);
+            cluster.gpu_total.push_back(gpu_total);
+            cluster.mem_total.push_back(mem_total);
+            cluster.mem_alloc.push_back(mem_alloc);
+            cluster.mem_free.push_back(mem_free);
+            cluster.state.push_back(parseNodeState(state));
+        }
+
+        return cluster;
     }
 
-    static std::vector<PartitionInfo> getPartitions() {
+    // Local time as sacct takes it, "2025-03-01T00:00:00".
+    static inline std::string sacctTime(std::time_t t) {
+        std::tm tm{};
+        localtime_r(&t, &tm);
+        char buf[32];
+        std::strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S", &tm);
+        return buf;
+    }
+
+    static inline bool isFinalState(const std::string& state) {
+        static const char* finals[] = {
+            "COMPLETED", "FAILED", "CANCELLED", "TIMEOUT", "OUT_OF_MEMORY",
+            "NODE_FAIL", "PREEMPTED", "BOOT_FAIL", "DEADLINE", "REVOKED",
+        };
+        for (const char* f : finals) {
+            // "CANCELLED by 1234"
+            if (state.compare(0, std::strlen(f), f) == 0) return true;
+        }
+        return false;
+    }
+
+    // Rows of `sacct -P --format=HISTORY_FORMAT`, in sacct's order. MaxRSS is
+    // only reported on steps, so the largest of a job's steps is folded into
+    // the job's row, and so is the largest per-node footprint.
+    static std::vector<JobHistory> parseHistory(const std::string& out) {
+        static Histogram& parse_hist = stats::get("parse:sacct");
+        stats::Scope scope(parse_hist);
+
+        std::vector<JobHistory> history;
+        std::unordered_map<std::string, size_t> rows;
+
+        std::istringstream hss(out);
+        for (std::string line; std::getline(hss, line); ) {
+            if (line.empty()) continue;
+
+            std::istringstream iss(line);
+            std::string field;
+            std::vector<std::string> fields;
+
+            while (std::getline(iss, field, '|')) {
+                fields.push_back(field);
+            }
+
+            if (fields.size() >= 7) {
+                // MaxRSS is that of the step's largest task; its tasks are
+                // spread over its nodes
+                long long node_rss = 0;
+                if (fields.size() > 7) {
+                    long long tasks = fields.size() > 18 ? std::max(1, std::atoi(fields[18].c_str())) : 1;
+                    long long nodes = fields.size() > 10 ? std::max(1, std::atoi(fields[10].c_str())) : 1;
+                    node_rss = parseMemory(fields[7]) * ((tasks + nodes - 1) / nodes);
+                }
+
+                // step entries (12345.batch, 12345.0) only lend their MaxRSS
+                size_t dot = fields[0].find('.');
+                if (dot != std::string::npos) {
+                    auto row = rows.find(fields[0].substr(0, dot));
+                    if (row != rows.end() && fields.size() > 7) {
+                        JobHistory& job = history[row->second];
+                        if (parseMemory(fields[7]) > parseMemory(job.max_rss)) job.max_rss = fields[7];
+                        job.node_rss_bytes = std::max(job.node_rss_bytes, node_rss);
+                    }
+                    continue;
+                }
+
+                api::JobHistory job;
+                job.id = fields[0];
+                job.name = fields[1];
+                job.state = fields[2];
+                job.start = fields[3];
+                job.end = fields[4];
+                job.elapsed = fields[5];
+                job.exit_code = fields[6];
+                if (fields.size() > 7) job.max_rss = fields[7];
+                if (fields.size() > 8) job.cpu_time = fields[8];
+                if (fields.size() > 9) job.ncpus = fields[9];
+                if (fields.size() > 10) job.nnodes = fields[10];
+                if (fields.size() > 11) job.partition = fields[11];
+                if (fields.size() > 12) job.account = fields[12];
+                if (fields.size() > 13) job.total_cpu = fields[13];
+                if (fields.size() > 14) job.req_mem = fields[14];
+                if (fields.size() > 15) job.submit = fields[15];
+                if (fields.size() > 16) job.time_limit = fields[16];
+                if (fields.size() > 17) job.alloc_tres = fields[17];
+                job.node_rss_bytes = node_rss;
+                rows[job.id] = history.size();
+                history.push_back(job);
+            }
+        }
+
+        return history;
+    }
+
+    static std::vector<PartitionInfo> fetchPartitions() {
         std::vector<PartitionInfo> partitions;
 
-        std::string cmd = "sinfo -o \"%P %a %l %D %T\" --noheader 2>/dev/null";
-        std::string out = exec(cmd);
+        std::string out = query("partitions", PARTITIONS_COMMAND);
+
+        static Histogram& parse_hist = stats::get("parse:sinfo");
+        stats::Scope scope(parse_hist);
 
         std::map<std::string, PartitionInfo> part_map;
 
@@ -308,9 +1505,11 @@ public:
         while (std::getline(iss, line)) {
             if (line.empty()) continue;
 
+            // one line per group of nodes sharing state and GRES usage, so
+            // per-node GPU counts scale by the line's node count
             std::istringstream lss(line);
-            std::string name, avail, timelimit, nodes_str, state;
-            lss >> name >> avail >> timelimit >> nodes_str >> state;
+            std::string name, avail, timelimit, nodes_str, state, cpus, gres, gres_used;
+            lss >> name >> avail >> timelimit >> nodes_str >> state >> cpus >> gres >> gres_used;
 
             if (!name.empty() && name.back() == '*') {
                 name.pop_back();
@@ -320,12 +1519,26 @@ public:
             try { nodes = std::stoi(nodes_str); } catch (...) {}
 
             if (part_map.find(name) == part_map.end()) {
-                part_map[name] = PartitionInfo{name, 0, 0, 0, 0, 0, timelimit, avail};
+                PartitionInfo info;
+                info.name = name;
+                info.timelimit = timelimit;
+                info.state = avail;
+                part_map[name] = info;
             }
 
             auto& p = part_map[name];
             p.nodes_total += nodes;
 
+            int alloc = 0, idle = 0, other = 0, total = 0;
+            if (std::sscanf(cpus.c_str(), "%d/%d/%d/%d", &alloc, &idle, &other, &total) == 4) {
+                p.cpus_alloc += alloc;
+                p.cpus_idle += idle;
+                p.cpus_other += other;
+                p.cpus_total += total;
+            }
+            p.gpus_total += countGpus(gres) * nodes;
+            p.gpus_used += countGpus(gres_used) * nodes;
+
             if (state.find("idle") != std::string::npos) p.nodes_idle += nodes;
             else if (state.find("mix") != std::string::npos) p.nodes_mix += nodes;
             else if (state.find("alloc") != std::string::npos) p.nodes_alloc += nodes;
@@ -340,113 +1553,465 @@ public:
         return partitions;
     }
 
-    static std::string getRawJobDetails(const std::string& job_id) {
-        return exec("scontrol show job " + job_id + " 2>&1");
+public:
+    static bool cancelJob(const std::string& job_id) {
+        return cancelJobs({job_id}).failed.empty();
     }
 
-    static std::string expandSlurmPath(const std::string& path, const std::string& job_id, const std::string& job_name) {
-        std::string result = path;
+    // Cancels many jobs with as few `scancel` calls as the command line
+    // allows. scancel reports each id it could not cancel on its own line
+    // ("... on job id <id>: <reason>"); every other id counts as cancelled,
+    // unless scancel timed out or failed silently, which fails the batch.
+    static CancelResult cancelJobs(const std::vector<std::string>& job_ids) {
+        constexpr size_t BATCH = 256;
+        CancelResult result;
+
+        std::vector<std::string> valid;
+        for (const auto& id : job_ids) {
+            if (validJobId(id)) valid.push_back(id);
+            else result.failed.emplace_back(id, "invalid job id");
+        }
+
+        for (size_t begin = 0; begin < valid.size(); begin += BATCH) {
+            size_t end = std::min(valid.size(), begin + BATCH);
+
+            std::string cmd = "scancel";
+            for (size_t i = begin; i < end; ++i) cmd += " " + valid[i];
+            int status = 0;
+            std::string out = mutate(cmd + " 2>&1", &status);
+
+            std::map<std::string, std::string> errors;
+            std::string batch_error;
+            if (status < 0) batch_error = "scancel timed out";
+            else if (status > 0 && out.empty()) batch_error = "scancel exited with status " + std::to_string(status);
+
+            std::istringstream iss(out);
+            for (std::string line; std::getline(iss, line); ) {
+                if (line.find("error") == std::string::npos) continue;
 
-        std::string base_job_id = job_id;
-        size_t dot_pos = job_id.find('.');
-        if (dot_pos != std::string::npos) {
-            base_job_id = job_id.substr(0, dot_pos);
+                size_t at = line.find("job id ");
+                if (at == std::string::npos) {
+                    batch_error = line;
+                    continue;
+                }
+                at += 7;
+                size_t id_end = line.find_first_of(": ", at);
+                std::string id = line.substr(at, id_end == std::string::npos ? std::string::npos : id_end - at);
+                size_t reason = line.find(": ", at);
+                errors[id] = reason == std::string::npos ? line : line.substr(reason + 2);
+            }
+
+            for (size_t i = begin; i < end; ++i) {
+                auto it = errors.find(valid[i]);
+                if (it != errors.end()) {
+                    result.failed.emplace_back(valid[i], it->second);
+                } else if (!batch_error.empty()) {
+                    result.failed.emplace_back(valid[i], batch_error);
+                } else {
+                    result.cancelled.push_back(valid[i]);
+                }
+            }
         }
 
-        size_t pos;
-        while ((pos = result.find("%J")) != std::string::npos) {
-            result.replace(pos, 2, job_id);
+        jobsFlight().invalidateAll();
+        for (const auto& id : valid) detailsFlight().invalidate(id);
+
+        return result;
+    }
+
+    // Live usage of every running step of a job, one `sstat` call.
+    static std::vector<StepUsage> getJobUsage(const std::string& job_id) {
+        std::vector<StepUsage> steps;
+
+        if (!validJobId(job_id)) return steps;
+        std::string out = exec("sstat -j " + job_id +
+                               " --allsteps -n -P --format=JobID,AveCPU,MaxRSS,TresUsageInAve,NTasks,AveDiskRead,AveDiskWrite,Nodelist 2>/dev/null");
+
+        static Histogram& parse_hist = stats::get("parse:sstat");
+        stats::Scope scope(parse_hist);
+
+        std::istringstream iss(out);
+        for (std::string line; std::getline(iss, line); ) {
+            std::vector<std::string> fields;
+            std::istringstream lss(line);
+            for (std::string field; std::getline(lss, field, '|'); ) fields.push_back(field);
+            if (fields.size() < 5) continue;
+
+            StepUsage step;
+            step.step = fields[0];
+            step.cpu_seconds = parseDuration(fields[1]);
+            step.max_rss_bytes = parseMemory(fields[2]);
+            try { step.ntasks = std::max(1, std::stoi(fields[4])); } catch (...) {}
+            if (fields.size() > 6) {
+                step.disk_read_bytes = parseMemory(fields[5]);
+                step.disk_write_bytes = parseMemory(fields[6]);
+            }
+            if (fields.size() > 7) step.nnodes = std::max(1, countHosts(fields[7]));
+
+            // TresUsageInAve carries the same average with finer resolution when present
+            size_t cpu = fields[3].find("cpu=");
+            if (cpu != std::string::npos) {
+                size_t end = fields[3].find(',', cpu);
+                step.cpu_seconds = parseDuration(fields[3].substr(cpu + 4, end == std::string::npos ? std::string::npos : end - cpu - 4));
+            }
+
+            steps.push_back(std::move(step));
         }
-        while ((pos = result.find("%j")) != std::string::npos) {
-            result.replace(pos, 2, base_job_id);
+
+        return steps;
+    }
+
+    // The steps of a job in sacct order, from one `sacct -j` parsed in one
+    // pass; usage of the steps still running (which sacct only fills in at
+    // their end) comes from one `sstat`.
+    static std::vector<JobStep> getJobSteps(const std::string& job_id) {
+        std::vector<JobStep> steps;
+
+        if (!validJobId(job_id)) return steps;
+        std::string out = exec("sacct -j " + job_id +
+                               " -n -P -o JobID,JobName,State,Elapsed,TotalCPU,NCPUS,MaxRSS,AveDiskRead,AveDiskWrite,NodeList 2>/dev/null");
+
+        bool running = false;
+        {
+            static Histogram& parse_hist = stats::get("parse:sacct");
+            stats::Scope scope(parse_hist);
+
+            std::istringstream iss(out);
+            for (std::string line; std::getline(iss, line); ) {
+                std::vector<std::string> fields;
+                std::istringstream lss(line);
+                for (std::string field; std::getline(lss, field, '|'); ) fields.push_back(field);
+                // the allocation row is the job itself
+                if (fields.size() < 10 || fields[0].find('.') == std::string::npos) continue;
+
+                JobStep step;
+                step.id = fields[0];
+                step.name = fields[1];
+                step.state = fields[2].substr(0, fields[2].find(' '));
+                step.elapsed_seconds = parseDuration(fields[3]);
+                step.cpu_seconds = parseDuration(fields[4]);
+                step.cpus = std::atoi(fields[5].c_str());
+                step.max_rss_bytes = parseMemory(fields[6]);
+                step.disk_read_bytes = parseMemory(fields[7]);
+                step.disk_write_bytes = parseMemory(fields[8]);
+                step.node_list = fields[9];
+                running = running || step.state == "RUNNING";
+                steps.push_back(std::move(step));
+            }
         }
-        while ((pos = result.find("%x")) != std::string::npos) {
-            result.replace(pos, 2, job_name);
+        if (!running) return steps;
+
+        // matched on the step suffix: sstat may name array tasks differently
+        auto suffix = [](const std::string& id) { return id.substr(id.find('.')); };
+        for (const auto& usage : getJobUsage(job_id)) {
+            if (usage.step.find('.') == std::string::npos) continue;
+            for (auto& step : steps) {
+                if (step.state != "RUNNING" || suffix(step.id) != suffix(usage.step)) continue;
+                step.cpu_seconds = usage.cpu_seconds * usage.ntasks;
+                step.max_rss_bytes = usage.max_rss_bytes;
+                step.disk_read_bytes = usage.disk_read_bytes;
+                step.disk_write_bytes = usage.disk_write_bytes;
+                step.live = true;
+            }
         }
+        return steps;
+    }
 
-        return result;
+    static std::string getRawJobDetails(const std::string& job_id) {
+        if (!validJobId(job_id)) return "";
+        return exec("scontrol show job " + job_id + " 2>&1");
     }
 
-    static std::pair<std::string, std::string> getJobLogPaths(const std::string& job_id) {
-        std::string raw = exec("scontrol show job " + job_id + " 2>/dev/null");
+    // Expands the filename patterns of sbatch --output/--error (%%, %A, %a,
+    // %J, %j, %N, %n, %s, %t, %u, %x), including zero padding as in "%4a".
+    // The batch step is the only writer of StdOut/StdErr, so %n and %t are
+    // 0 and %s is "batch".
+    static std::string expandSlurmPath(const std::string& pattern, const LogContext& ctx) {
+        std::string result;
+        result.reserve(pattern.size() + 32);
 
-        std::string stdout_path, stderr_path, job_name;
+        for (size_t i = 0; i < pattern.size(); ++i) {
+            if (pattern[i] != '%' || i + 1 >= pattern.size()) {
+                result += pattern[i];
+                continue;
+            }
 
-        std::regex stdout_re(R"(StdOut=([^\s]+))");
-        std::regex stderr_re(R"(StdErr=([^\s]+))");
-        std::regex name_re(R"(JobName=([^\s]+))");
+            size_t j = i + 1;
+            size_t width = 0;
+            while (j < pattern.size() && std::isdigit((unsigned char)pattern[j])) width = width * 10 + (pattern[j++] - '0');
+            if (j >= pattern.size()) {
+                result += pattern.substr(i);
+                break;
+            }
 
-        std::smatch m;
-        if (std::regex_search(raw, m, name_re)) job_name = m[1].str();
-        if (std::regex_search(raw, m, stdout_re)) stdout_path = expandSlurmPath(m[1].str(), job_id, job_name);
-        if (std::regex_search(raw, m, stderr_re)) stderr_path = expandSlurmPath(m[1].str(), job_id, job_name);
+            std::string value;
+            switch (pattern[j]) {
+                case '%': value = "%"; break;
+                case 'A': value = ctx.array_job_id.empty() ? ctx.job_id : ctx.array_job_id; break;
+                case 'a': value = ctx.array_task_id.empty() ? "4294967294" : ctx.array_task_id; break;
+                case 'J': value = ctx.job_id; break;
+                case 'j': value = ctx.job_id.substr(0, ctx.job_id.find('.')); break;
+                case 'N': value = ctx.node; break;
+                case 'n': value = "0"; break;
+                case 's': value = "batch"; break;
+                case 't': value = "0"; break;
+                case 'u': value = ctx.user; break;
+                case 'x': value = ctx.job_name; break;
+                default: value = pattern.substr(i, j - i + 1); break;
+            }
 
-        return {stdout_path, stderr_path};
-    }
+            if (value.size() < width && pattern[j] != '%') value.insert(0, width - value.size(), '0');
+            result += value;
+            i = j;
+        }
 
-    static std::vector<JobHistory> getJobHistory(const std::string& filter = "") {
-        std::vector<JobHistory> history;
+        return result;
+    }
 
-        const char* user = std::getenv("USER");
-        if (!user) user = "unknown";
+    // Log files of a job and, for an array or het job, of every task or
+    // component: one `scontrol show job -o` for the whole group. Tasks that
+    // already left the queue come from one `sacct -X` over the array, with
+    // the same filename pattern.
+    static std::vector<LogSource> getJobLogSources(const std::string& job_id) {
+        auto records = [](const std::string& raw) {
+            std::vector<std::map<std::string, std::string>> out;
+            std::istringstream iss(raw);
+            for (std::string line; std::getline(iss, line); ) {
+                std::map<std::string, std::string> fields;
+                std::istringstream lss(line);
+                for (std::string token; lss >> token; ) {
+                    size_t eq = token.find('=');
+                    if (eq != std::string::npos) fields[token.substr(0, eq)] = token.substr(eq + 1);
+                }
+                if (fields.count("JobId")) out.push_back(std::move(fields));
+            }
+            return out;
+        };
 
-        std::string cmd = "sacct -u " + std::string(user) +
-                        " --starttime=now-7days"
-                        " --format=JobID,JobName%30,State,Start,End,Elapsed,ExitCode,MaxRSS,CPUTime,NCPUs,NNodes,Partition,Account"
-                        " --noheader -P 2>/dev/null";
+        if (!validJobId(job_id)) return {};
+        auto jobs = records(exec("scontrol show job -o " + job_id + " 2>/dev/null"));
+        if (jobs.empty()) return {};
 
-        if (!filter.empty()) {
-            cmd = "sacct -u " + std::string(user) +
-                " --starttime=now-7days -s " + filter +
-                " --format=JobID,JobName%30,State,Start,End,Elapsed,ExitCode,MaxRSS,CPUTime,NCPUs,NNodes,Partition,Account"
-                " --noheader -P 2>/dev/null";
+        std::string group = jobs[0].count("ArrayJobId") ? jobs[0]["ArrayJobId"] : jobs[0]["HetJobId"];
+        if (validJobId(group) && group != job_id) {
+            auto all = records(exec("scontrol show job -o " + group + " 2>/dev/null"));
+            if (!all.empty()) jobs = std::move(all);
         }
 
-        std::array<char, 512> buffer;
-        std::unique_ptr<FILE, int(*)(FILE*)> pipe(
-            popen(cmd.c_str(), "r"),
-            static_cast<int(*)(FILE*)>(pclose)
-        );
+        auto context = [](std::map<std::string, std::string>& job) {
+            LogContext ctx;
+            ctx.job_id = job["JobId"];
+            ctx.array_job_id = job["ArrayJobId"];
+            ctx.array_task_id = job["ArrayTaskId"];
+            ctx.job_name = job["JobName"];
+            ctx.user = job["UserId"].substr(0, job["UserId"].find('('));
+            ctx.node = job["BatchHost"];
+            return ctx;
+        };
+
+        std::map<long, LogSource> tasks;
+        std::vector<LogSource> sources;
+        std::vector<std::pair<long, long>> pending;
+
+        // any task record, to derive the paths of tasks no longer listed
+        LogContext sample;
+        std::string sample_stdout, sample_stderr;
+
+        for (auto& job : jobs) {
+            LogContext ctx = context(job);
+            const std::string& task = ctx.array_task_id;
+            bool range = task.find_first_of("-,[") != std::string::npos;
+
+            // prefer a task that ran over the record of the pending range
+            bool sample_is_range = sample.array_task_id.find_first_of("-,[") != std::string::npos;
+            if (!task.empty() && (sample.array_task_id.empty() || (sample_is_range && !range))) {
+                sample = ctx;
+                sample_stdout = job["StdOut"];
+                sample_stderr = job["StdErr"];
+            }
 
-        if (!pipe) return history;
+            // the record standing for pending tasks has a range and no logs yet
+            if (range) {
+                parseTaskSpec(task, pending);
+                continue;
+            }
 
-        while (fgets(buffer.data(), buffer.size(), pipe.get()) != nullptr) {
-            std::string line = buffer.data();
-            if (line.empty() || line[0] == '\n') continue;
+            LogSource source;
+            source.stdout_path = expandSlurmPath(job["StdOut"], ctx);
+            source.stderr_path = expandSlurmPath(job["StdErr"], ctx);
 
-            if (!line.empty() && line.back() == '\n') line.pop_back();
+            if (!task.empty()) {
+                source.label = task;
+                tasks[std::atol(task.c_str())] = source;
+            } else {
+                source.label = job.count("HetJobOffset") ? "+" + job["HetJobOffset"] : ctx.job_id;
+                sources.push_back(source);
+            }
+        }
 
-            std::istringstream iss(line);
-            std::string field;
-            std::vector<std::string> fields;
+        if (!sample.array_task_id.empty()) {
+            auto inPending = [&](long id) {
+                for (const auto& range : pending) if (id >= range.first && id <= range.second) return true;
+                return false;
+            };
+
+            // tasks that finished have left scontrol; sacct names them, so no
+            // task id is probed on the filesystem
+            std::string finished;
+            if (validJobId(sample.array_job_id)) {
+                finished = exec("sacct -j " + sample.array_job_id + " -X -n -P -o JobID 2>/dev/null");
+            }
 
-            while (std::getline(iss, field, '|')) {
-                fields.push_back(field);
+            std::istringstream fss(finished);
+            for (std::string line; std::getline(fss, line); ) {
+                size_t underscore = line.find('_');
+                if (underscore == std::string::npos || underscore + 1 == line.size() ||
+                    line.find_first_not_of("0123456789", underscore + 1) != std::string::npos) continue;
+
+                long id = std::atol(line.c_str() + underscore + 1);
+                if (tasks.count(id) || inPending(id)) continue;
+
+                LogSource source;
+                source.label = std::to_string(id);
+                source.stdout_path = taskLogPath(sample_stdout, sample, id);
+                source.stderr_path = taskLogPath(sample_stderr, sample, id);
+                if (!source.stdout_path.empty()) tasks[id] = source;
             }
 
-            if (fields.size() >= 7) {
-                // Skip step entries (those with . in JobID like 12345.batch)
-                if (fields[0].find('.') != std::string::npos) continue;
+            for (auto& [id, source] : tasks) sources.push_back(std::move(source));
+        }
 
-                api::JobHistory job;
-                job.id = fields[0];
-                job.name = fields[1];
-                job.state = fields[2];
-                job.start = fields[3];
-                job.end = fields[4];
-                job.elapsed = fields[5];
-                job.exit_code = fields[6];
-                if (fields.size() > 7) job.max_rss = fields[7];
-                if (fields.size() > 8) job.cpu_time = fields[8];
-                if (fields.size() > 9) job.ncpus = fields[9];
-                if (fields.size() > 10) job.nnodes = fields[10];
-                if (fields.size() > 11) job.partition = fields[11];
-                if (fields.size() > 12) job.account = fields[12];
-                history.push_back(job);
+        return sources;
+    }
+
+    static std::pair<std::string, std::string> getJobLogPaths(const std::string& job_id) {
+        auto sources = getJobLogSources(job_id);
+        if (sources.empty()) return {};
+        return {sources[0].stdout_path, sources[0].stderr_path};
+    }
+
+    // Called as the windows of a history query complete, with the jobs not
+    // delivered before; returning false abandons the windows not started.
+    using HistoryChunk = std::function<bool(const std::vector<JobHistory>& jobs, int done, int total)>;
+
+    // Jobs of the last `days` days, newest first. slurmdbd is asked one day
+    // at a time, HISTORY_PARALLELISM days at once, newest first; days that
+    // are over with every job finished come from HistoryCache instead.
+    static std::vector<JobHistory> getJobHistory(const std::string& filter = "", int days = 7,
+                                                 HistoryChunk on_chunk = nullptr) {
+        const char* user = std::getenv("USER");
+        if (!user) user = "unknown";
+
+        struct Window {
+            std::time_t start = 0;
+            std::time_t end = 0;  // 0: up to now
+            std::vector<JobHistory> jobs;
+            bool done = false;
+        };
+
+        // windows start at local midnight so a closed one keeps its cache key
+        std::time_t now = std::time(nullptr);
+        std::tm midnight{};
+        localtime_r(&now, &midnight);
+        midnight.tm_hour = midnight.tm_min = midnight.tm_sec = 0;
+
+        std::vector<Window> windows;  // oldest first
+        for (int d = days; d >= 0; --d) {
+            std::tm day = midnight;
+            day.tm_mday -= d;
+            day.tm_isdst = -1;
+            Window w;
+            w.start = std::mktime(&day);
+            day.tm_mday += 1;
+            day.tm_isdst = -1;
+            if (d > 0) w.end = std::mktime(&day);
+            windows.push_back(w);
+        }
+
+        auto key = [&](const Window& w) {
+            char buf[160];
+            std::snprintf(buf, sizeof(buf), "%s-%s-%lld-%lld-%zx", user, filter.empty() ? "all" : filter.c_str(),
+                          (long long)w.start, (long long)w.end, std::hash<std::string>{}(HISTORY_FORMAT));
+            return std::string(buf);
+        };
+
+        // slurmdbd may still be catching up on the last minutes of a window
+        auto closed = [&](const Window& w) { return w.end != 0 && w.end <= now - 300; };
+
+        static const HistoryCache cache;
+        // replayed or fixture output never reaches the user's cache
+        bool cached = !hasRunner();
+
+        std::mutex m;
+        std::set<std::string> delivered;
+        int done = 0;
+        bool stop = false;
+
+        auto complete = [&](Window& w) {
+            std::lock_guard<std::mutex> lock(m);
+            w.done = true;
+            ++done;
+            if (!on_chunk || stop) return;
+
+            std::vector<JobHistory> fresh;
+            for (const auto& job : w.jobs) {
+                if (delivered.insert(job.id).second) fresh.push_back(job);
+            }
+            if (!on_chunk(fresh, done, (int)windows.size())) stop = true;
+        };
+
+        std::vector<Window*> pending;  // newest first
+        for (auto it = windows.rbegin(); it != windows.rend(); ++it) {
+            std::string out;
+            if (cached && closed(*it) && cache.load(key(*it), out)) {
+                it->jobs = parseHistory(out);
+                complete(*it);
+            } else {
+                pending.push_back(&*it);
             }
         }
 
-        std::reverse(history.begin(), history.end());
+        std::atomic<size_t> next{0};
+        auto worker = [&] {
+            for (size_t i; (i = next++) < pending.size(); ) {
+                {
+                    std::lock_guard<std::mutex> lock(m);
+                    if (stop) return;
+                }
+
+                Window& w = *pending[i];
+                std::string cmd = "sacct -u " + std::string(user) +
+                                  " --starttime=" + sacctTime(w.start) +
+                                  (w.end ? " --endtime=" + sacctTime(w.end) : "") +
+                                  (filter.empty() ? "" : " -s " + filter) +
+                                  " --format=" + HISTORY_FORMAT + " --noheader -P 2>/dev/null";
+                int status = 0;
+                std::string out = exec(cmd, &status);
+                w.jobs = parseHistory(out);
+
+                // only an answer sacct really gave: a timeout, a failure or a
+                // call the breaker held back would cache an empty day for good
+                bool final = std::all_of(w.jobs.begin(), w.jobs.end(), [](const JobHistory& job) {
+                    return isFinalState(job.state);
+                });
+                if (cached && status == 0 && closed(w) && final) cache.store(key(w), out);
+
+                complete(w);
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < std::min<size_t>(HISTORY_PARALLELISM, pending.size()); ++t) workers.emplace_back(worker);
+        for (auto& t : workers) t.join();
+
+        // a job spanning days is listed by each; the newest answer wins
+        std::vector<JobHistory> history;
+        std::set<std::string> seen;
+        for (auto w = windows.rbegin(); w != windows.rend(); ++w) {
+            for (auto job = w->jobs.rbegin(); job != w->jobs.rend(); ++job) {
+                if (seen.insert(job->id).second) history.push_back(std::move(*job));
+            }
+        }
         return history;
     }
 
@@ -0,0 +1,131 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "slurmjobs.hpp"
+
+namespace api {
+
+// One published version of what the job view shows. Never modified once
+// published: writers copy the snapshot (the members are shared, so this is
+// cheap), replace what changed and publish the copy.
+struct Snapshot {
+    uint64_t version = 0;
+
+    // rows of the job list, with the tasks of expanded arrays under their row
+    std::shared_ptr<const std::vector<Job>> jobs = std::make_shared<const std::vector<Job>>();
+    // arrays whose tasks are listed
+    std::set<std::string> expanded;
+
+    // details of the selected row, fetched for `focus` (its detail_id)
+    std::string focus;
+    std::shared_ptr<const DetailedJob> details = std::make_shared<const DetailedJob>();
+
+    // jobs pinned to the dashboard, in pinning order, and their tiles
+    std::vector<std::string> pinned;
+    std::shared_ptr<const std::vector<JobTile>> tiles = std::make_shared<const std::vector<JobTile>>();
+
+    // who else runs on the nodes of the focused job, fetched while `cotenancy`
+    bool cotenancy = false;
+    std::shared_ptr<const std::vector<NodeTenancy>> tenancy = std::make_shared<const std::vector<NodeTenancy>>();
+
+    std::chrono::steady_clock::time_point taken = std::chrono::steady_clock::now();
+};
+
+// Holds the latest Snapshot behind an atomically swapped shared_ptr, like the
+// rsvd poller: readers take a reference and keep a consistent view for as
+// long as they hold it, writers build the next version off to the side and
+// never block them.
+class SnapshotStore {
+private:
+    std::shared_ptr<const Snapshot> current = std::make_shared<const Snapshot>();
+
+public:
+    std::shared_ptr<const Snapshot> load() const {
+        return std::atomic_load(&current);
+    }
+
+    // Publishes `next` unless another version was published since `base` was
+    // loaded; the caller then rebuilds from the newer one.
+    bool publish(const std::shared_ptr<const Snapshot>& base, Snapshot next) {
+        next.version = base->version + 1;
+        auto expected = base;
+        return std::atomic_compare_exchange_strong(&current, &expected, std::make_shared<const Snapshot>(std::move(next)));
+    }
+
+    // Applies `change` to a copy of the latest version and publishes it,
+    // retrying if a fetcher got in first.
+    template <typename F>
+    std::shared_ptr<const Snapshot> update(F change) {
+        for (;;) {
+            auto base = load();
+            Snapshot next = *base;
+            change(next);
+            if (publish(base, next)) return load();
+        }
+    }
+};
+
+// Lists the tasks of the array at `row` under it.
+inline void expandArray(std::vector<Job>& jobs, size_t row) {
+    auto tasks = slurm::getArrayTasks(jobs[row].id);
+    jobs.insert(jobs.begin() + row + 1, tasks.begin(), tasks.end());
+}
+
+// Fetches the next version from `base`: the user's jobs, the tasks of the
+// arrays still expanded and the details of the focused row if it is still
+// listed (otherwise of the first row) and the other jobs on its nodes, plus
+// the tiles of the pinned jobs. Runs on any thread.
+inline Snapshot fetchSnapshot(const Snapshot& base) {
+    Snapshot next = base;
+    auto jobs = slurm::getUserJobs();
+
+    std::set<std::string> arrays;
+    for (size_t i = jobs.size(); i-- > 0; ) {
+        if (!jobs[i].isArray()) continue;
+        arrays.insert(jobs[i].id);
+        if (base.expanded.count(jobs[i].id)) expandArray(jobs, i);
+    }
+
+    next.expanded.clear();
+    for (const auto& id : base.expanded) {
+        if (arrays.count(id)) next.expanded.insert(id);
+    }
+
+    bool listed = false;
+    for (const auto& job : jobs) listed = listed || job.detail_id == base.focus;
+    next.focus = listed || jobs.empty() ? base.focus : jobs[0].detail_id;
+    if (!next.focus.empty()) next.details = std::make_shared<const DetailedJob>(slurm::getJobDetails(next.focus));
+    if (base.cotenancy) next.tenancy = std::make_shared<const std::vector<NodeTenancy>>(slurm::getNodeTenancy(*next.details));
+
+    // jobs that left the queue show as such once, then are unpinned; without
+    // an answer from squeue the pins and their last tiles stay
+    bool answered = false;
+    auto tiles = base.pinned.empty() ? std::vector<JobTile>() : slurm::getJobTiles(base.pinned, &answered);
+    if (answered) {
+        next.pinned.clear();
+        for (const auto& tile : tiles) {
+            if (tile.listed) next.pinned.push_back(tile.id);
+        }
+        next.tiles = std::make_shared<const std::vector<JobTile>>(std::move(tiles));
+    }
+
+    next.jobs = std::make_shared<const std::vector<Job>>(std::move(jobs));
+    next.taken = std::chrono::steady_clock::now();
+    return next;
+}
+
+// Fetches and publishes a new version, refetching if the UI published one
+// (selection, expanded array) while the commands ran.
+inline std::shared_ptr<const Snapshot> refresh(SnapshotStore& store) {
+    for (;;) {
+        auto base = store.load();
+        if (store.publish(base, fetchSnapshot(*base))) return store.load();
+    }
+}
+
+}
@@ -0,0 +1,129 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace api {
+
+// Latency histogram with log-spaced buckets (4 per power of two, ~19%
+// resolution) covering 1 us to ~70 min. Recording is a handful of relaxed
+// atomic increments so it can sit on every exec, parse and frame.
+class Histogram {
+public:
+    static constexpr int SUB_BUCKETS = 4;
+    static constexpr int BUCKETS = 32 * SUB_BUCKETS;
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKETS> counts{};
+    std::atomic<uint64_t> total{0};
+    std::atomic<uint64_t> sum_us{0};
+    std::atomic<uint64_t> max_us{0};
+    std::atomic<uint64_t> bytes{0};
+
+    static int bucketOf(uint64_t us) {
+        if (us < 1) us = 1;
+        int b = (int)(std::log2((double)us) * SUB_BUCKETS);
+        return std::min(b, BUCKETS - 1);
+    }
+
+    static double bucketUpper(int b) {
+        return std::exp2((double)(b + 1) / SUB_BUCKETS);
+    }
+
+public:
+    void record(uint64_t us, uint64_t read_bytes = 0) {
+        counts[bucketOf(us)].fetch_add(1, std::memory_order_relaxed);
+        total.fetch_add(1, std::memory_order_relaxed);
+        sum_us.fetch_add(us, std::memory_order_relaxed);
+        bytes.fetch_add(read_bytes, std::memory_order_relaxed);
+
+        uint64_t prev = max_us.load(std::memory_order_relaxed);
+        while (us > prev && !max_us.compare_exchange_weak(prev, us, std::memory_order_relaxed)) {}
+    }
+
+    uint64_t count() const { return total.load(std::memory_order_relaxed); }
+    uint64_t totalBytes() const { return bytes.load(std::memory_order_relaxed); }
+    double maxMs() const { return max_us.load(std::memory_order_relaxed) / 1000.0; }
+
+    double meanMs() const {
+        uint64_t n = count();
+        return n ? sum_us.load(std::memory_order_relaxed) / 1000.0 / n : 0;
+    }
+
+    // Upper bound of the bucket holding the p-th percentile, in milliseconds.
+    double percentileMs(double p) const {
+        uint64_t n = count();
+        if (n == 0) return 0;
+
+        uint64_t rank = (uint64_t)std::ceil(p / 100.0 * n);
+        uint64_t seen = 0;
+        for (int b = 0; b < BUCKETS; ++b) {
+            seen += counts[b].load(std::memory_order_relaxed);
+            if (seen >= rank) return std::min(bucketUpper(b) / 1000.0, maxMs());
+        }
+        return maxMs();
+    }
+};
+
+class stats {
+private:
+    static inline std::mutex m;
+    static inline std::map<std::string, std::unique_ptr<Histogram>> registry;
+
+public:
+    // Histograms live for the whole run, so callers may keep the reference.
+    static Histogram& get(const std::string& name) {
+        std::lock_guard<std::mutex> lock(m);
+        auto& h = registry[name];
+        if (!h) h = std::make_unique<Histogram>();
+        return *h;
+    }
+
+    static std::vector<std::pair<std::string, const Histogram*>> all() {
+        std::lock_guard<std::mutex> lock(m);
+        std::vector<std::pair<std::string, const Histogram*>> out;
+        for (const auto& [name, h] : registry) out.emplace_back(name, h.get());
+        return out;
+    }
+
+    static bool dump(const std::string& path) {
+        std::ofstream file(path);
+        if (!file.is_open()) return false;
+
+        file << "name\tcount\tmean_ms\tp50_ms\tp90_ms\tp99_ms\tmax_ms\tbytes\n";
+        for (const auto& [name, h] : all()) {
+            file << name << '\t' << h->count() << '\t' << h->meanMs() << '\t'
+                 << h->percentileMs(50) << '\t' << h->percentileMs(90) << '\t'
+                 << h->percentileMs(99) << '\t' << h->maxMs() << '\t' << h->totalBytes() << '\n';
+        }
+        return true;
+    }
+
+    // Records the lifetime of the scope into a histogram.
+    class Scope {
+    private:
+        Histogram& h;
+        std::chrono::steady_clock::time_point start;
+
+    public:
+        explicit Scope(Histogram& h) : h(h), start(std::chrono::steady_clock::now()) {}
+        ~Scope() {
+            auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count();
+            h.record(us);
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+};
+
+}
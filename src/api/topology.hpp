@@ -0,0 +1,100 @@
+#pragma once
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "slurmjobs.hpp"
+
+namespace api {
+
+// Where an allocation lands on a node's sockets, cores and hardware threads,
+// and whether its GPUs sit on the sockets of its cores.
+// Slurm numbers CPU ids thread first: id = (socket × cores per socket +
+// core) × threads per core + thread. scontrol reports no NUMA layout, so
+// sockets stand in for NUMA domains.
+struct Placement {
+    int sockets = 1;
+    int cores_per_socket = 1;
+    int threads_per_core = 1;
+
+    // allocated threads of each core, socket after socket
+    std::vector<int> threads;
+    // cores with an allocated thread, per socket
+    std::vector<int> cores_used;
+
+    int sockets_used = 0;
+    // spans more sockets than its cores need
+    bool split = false;
+    // cores with more than one of their threads allocated
+    int packed_cores = 0;
+    // our GPUs with none of our cores on their sockets
+    std::vector<int> remote_gpus;
+
+    int at(int socket, int core) const { return threads[socket * cores_per_socket + core]; }
+    bool warn() const { return split || packed_cores > 0 || !remote_gpus.empty(); }
+};
+
+// Indices of the GPUs of `node` that are ours; the first ones when Slurm
+// listed only a count.
+inline std::vector<int> ownedGpus(const NodeAllocation& node) {
+    if (!node.gpu_ids.empty()) return node.gpu_ids;
+    std::vector<int> ids;
+    for (int i = 0; i < node.allocated_gpus; ++i) ids.push_back(i);
+    return ids;
+}
+
+inline Placement placement(const NodeAllocation& node) {
+    Placement p;
+    p.sockets = std::max(1, node.sockets);
+    p.threads_per_core = std::max(1, node.threads_per_core);
+    p.cores_per_socket = node.cores_per_socket > 0 ? node.cores_per_socket
+                                                   : std::max(1, node.total_cores / (p.sockets * p.threads_per_core));
+
+    int cores = p.sockets * p.cores_per_socket;
+    p.threads.assign(cores, 0);
+    p.cores_used.assign(p.sockets, 0);
+
+    for (int id : node.allocated_cores) {
+        int core = id / p.threads_per_core;
+        if (id < 0 || core >= cores) continue;
+        if (p.threads[core]++ == 0) ++p.cores_used[core / p.cores_per_socket];
+    }
+
+    int used = 0;
+    for (int c : p.cores_used) {
+        used += c;
+        if (c > 0) ++p.sockets_used;
+    }
+    p.split = p.sockets_used > (used + p.cores_per_socket - 1) / p.cores_per_socket;
+    p.packed_cores = std::count_if(p.threads.begin(), p.threads.end(), [](int t) { return t > 1; });
+
+    // only judged when the node's Gres names the sockets of its GPUs
+    for (int gpu : ownedGpus(node)) {
+        if (gpu < 0 || gpu >= (int)node.gpu_affinity.size() || !node.gpu_affinity[gpu]) continue;
+        bool local = false;
+        for (int socket = 0; socket < p.sockets && socket < 32; ++socket) {
+            local = local || ((node.gpu_affinity[gpu] >> socket & 1u) && p.cores_used[socket] > 0);
+        }
+        if (!local && used > 0) p.remote_gpus.push_back(gpu);
+    }
+    return p;
+}
+
+// What is wrong with a placement, for a warning line; empty when nothing is.
+inline std::string placementWarning(const Placement& p) {
+    std::string warning;
+    if (p.split) warning = "split over " + std::to_string(p.sockets_used) + " sockets";
+    if (p.packed_cores > 0) {
+        if (!warning.empty()) warning += ", ";
+        warning += std::to_string(p.packed_cores) + " cores with sibling threads";
+    }
+    if (!p.remote_gpus.empty()) {
+        if (!warning.empty()) warning += ", ";
+        warning += "GPU";
+        for (size_t i = 0; i < p.remote_gpus.size(); ++i) warning += (i ? "," : " ") + std::to_string(p.remote_gpus[i]);
+        warning += " far from our cores";
+    }
+    return warning;
+}
+
+}
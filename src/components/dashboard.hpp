@@ -0,0 +1,93 @@
+#pragma once
+
+#include <ftxui/component/component.hpp>
+#include <ftxui/dom/elements.hpp>
+#include <algorithm>
+#include "../api/slurmjobs.hpp"
+#include "jobdetails.hpp"
+
+namespace ui {
+
+// The job's share of a node as a heat glyph, on the scale of the heatmap.
+inline Element tileCell(const api::JobTile::Node& node) {
+    using namespace ftxui;
+
+    float cpu = node.total_cores > 0 ? (float)node.cores / node.total_cores : 0.f;
+    float gpu = node.total_gpus > 0 ? (float)node.gpus / node.total_gpus : 0.f;
+    float load = std::max(cpu, gpu);
+
+    if (load <= 0.f)  return text("·") | color(Color::Green);
+    if (load < 0.25f) return text("░") | color(Color::GreenLight);
+    if (load < 0.50f) return text("▒") | color(Color::Yellow);
+    if (load < 1.00f) return text("▓") | color(Color::YellowLight);
+    return text("█") | color(Color::Red);
+}
+
+// One pinned job: state, times, totals and a glyph per node it holds.
+inline Element jobTile(const api::JobTile& tile, int width) {
+    using namespace ftxui;
+
+    if (!tile.listed) {
+        return vbox({
+            text(tile.id) | bold,
+            text("no longer queued") | dim,
+        }) | border | size(WIDTH, EQUAL, width);
+    }
+
+    std::string name = tile.name.size() > (size_t)width - 24 ? tile.name.substr(0, width - 25) + "…" : tile.name;
+
+    std::vector<Element> lines;
+    lines.push_back(hbox({text(name) | bold, text(" " + tile.id) | dim, filler(), text(tile.state) | color(statusColor(tile.state))}));
+    lines.push_back(hbox({
+        text(tile.partition) | color(Color::BlueLight),
+        filler(),
+        text(tile.elapsed + " / " + tile.limit) | dim,
+    }));
+    lines.push_back(text(std::to_string(tile.nodes) + " nodes  " + std::to_string(tile.cpus) + " cores  " + std::to_string(tile.gpus) + " GPUs"));
+
+    if (!tile.allocation.empty()) {
+        int per_row = std::max(1, width - 4);
+        std::vector<Element> row;
+        for (const auto& node : tile.allocation) {
+            row.push_back(tileCell(node));
+            if ((int)row.size() == per_row) {
+                lines.push_back(hbox(row));
+                row.clear();
+            }
+        }
+        if (!row.empty()) lines.push_back(hbox(row));
+    }
+
+    return vbox(lines) | border | size(WIDTH, EQUAL, width);
+}
+
+// Pinned jobs side by side, as many per row as the width allows.
+inline Element dashboard(const std::vector<api::JobTile>& tiles, int width) {
+    using namespace ftxui;
+
+    constexpr int tile_width = 44;
+
+    if (tiles.empty()) {
+        return vbox({
+            text("No pinned jobs") | bold,
+            text("t: pin or unpin the selected job") | dim,
+        });
+    }
+
+    int per_row = std::max(1, width / tile_width);
+
+    std::vector<Element> rows;
+    std::vector<Element> row;
+    for (const auto& tile : tiles) {
+        row.push_back(jobTile(tile, tile_width));
+        if ((int)row.size() == per_row) {
+            rows.push_back(hbox(row));
+            row.clear();
+        }
+    }
+    if (!row.empty()) rows.push_back(hbox(row));
+
+    return vbox(rows);
+}
+
+}
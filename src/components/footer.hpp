@@ -20,15 +20,33 @@ inline Element footer() {
         text("c") | bold | color(Color::Blue),
         text(":Cancel") | dim,
         text("  "),
+        text("m") | bold | color(Color::Blue),
+        text(":Mark") | dim,
+        text("  "),
         text("p") | bold | color(Color::Blue),
         text(":Parts") | dim,
         text("  "),
+        text("n") | bold | color(Color::Blue),
+        text(":Nodes") | dim,
+        text("  "),
         text("l") | bold | color(Color::Blue),
         text(":Logs") | dim,
         text("  "),
+        text("s") | bold | color(Color::Blue),
+        text(":Steps") | dim,
+        text("  "),
+        text("d") | bold | color(Color::Blue),
+        text(":Dashboard") | dim,
+        text("  "),
+        text("o") | bold | color(Color::Blue),
+        text(":Neighbours") | dim,
+        text("  "),
         text("a") | bold | color(Color::Blue),
         text(":History") | dim,
         text("  "),
+        text("e") | bold | color(Color::Blue),
+        text(":Efficiency") | dim,
+        text("  "),
         text("u") | bold | color(Color::Blue),
         text(":Quota") | dim,
         text("  "),
@@ -2,6 +2,7 @@
 
 #include <ftxui/component/component.hpp>
 #include <ftxui/dom/elements.hpp>
+#include <map>
 #include <string>
 
 #include "../api/slurmjobs.hpp"
@@ -9,16 +10,32 @@
 
 namespace ui {
 
+// squeue's compact state codes (%t) for the long names (%T).
+inline std::string shortState(const std::string& state) {
+    static const std::map<std::string, std::string> codes = {
+        {"PENDING", "PD"}, {"RUNNING", "R"}, {"SUSPENDED", "S"}, {"COMPLETING", "CG"},
+        {"COMPLETED", "CD"}, {"CONFIGURING", "CF"}, {"CANCELLED", "CA"}, {"FAILED", "F"},
+        {"TIMEOUT", "TO"}, {"PREEMPTED", "PR"}, {"NODE_FAIL", "NF"}, {"REQUEUED", "RQ"},
+    };
+    auto it = codes.find(state);
+    return it != codes.end() ? it->second : state.substr(0, 2);
+}
+
+inline ftxui::Color statusColor(const std::string& state) {
+    using ftxui::Color;
+    if (state == "RUNNING")   return Color::Green;
+    if (state == "PENDING")   return Color::Yellow;
+    if (state == "COMPLETED") return Color::Blue;
+    if (state == "FAILED")    return Color::Red;
+    if (state == "CANCELLED") return Color::Magenta;
+    return Color::Default;
+}
+
 inline ftxui::Component jobdetails(const api::DetailedJob& job) {
     using namespace ftxui;
 
     return Renderer([job] {
-        Color status_color = Color::Default;
-        if      (job.status == "RUNNING")   status_color = Color::Green;
-        else if (job.status == "PENDING")   status_color = Color::Yellow;
-        else if (job.status == "COMPLETED") status_color = Color::Blue;
-        else if (job.status == "FAILED")    status_color = Color::Red;
-        else if (job.status == "CANCELLED") status_color = Color::Magenta;
+        Color status_color = statusColor(job.status);
 
         std::vector<Element> elements = {
             hbox({text("Job ID: "), text(job.id) | color(Color::Magenta)}),
@@ -2,58 +2,356 @@
 
 #include <ftxui/component/component.hpp>
 #include <ftxui/dom/elements.hpp>
+#include <algorithm>
+#include <memory>
 #include "../api/slurmjobs.hpp"
+#include "../api/topology.hpp"
 
 namespace ui {
 
-inline ftxui::Component nodedetails(const api::DetailedJob& job, int width) {
+// Marks which cores of a node are allocated, one lookup per core.
+inline std::vector<bool> coreBitmap(const api::NodeAllocation& node) {
+    std::vector<bool> used(std::max(0, node.total_cores), false);
+    for (int core : node.allocated_cores) {
+        if (core >= 0 && core < node.total_cores) used[core] = true;
+    }
+    return used;
+}
+
+// Marks which GPUs of a node are ours, by index.
+inline std::vector<bool> gpuBitmap(const api::NodeAllocation& node) {
+    std::vector<bool> used(std::max(0, node.total_gpus), false);
+    for (int gpu : api::ownedGpus(node)) {
+        if (gpu >= 0 && gpu < node.total_gpus) used[gpu] = true;
+    }
+    return used;
+}
+
+// A node is short of memory below this share of RealMemory free, and we
+// asked for too much when our Mem= is this many times what a node uses.
+constexpr float LOW_FREE_MEMORY = 0.10f;
+constexpr long long OVERSIZED_MEMORY = 4;
+
+inline bool lowFreeMemory(const api::NodeAllocation& node) {
+    return node.free_memory_mb >= 0 && node.real_memory_mb > 0 &&
+           node.free_memory_mb < node.real_memory_mb * LOW_FREE_MEMORY;
+}
+
+// `node_rss_bytes` is the job's peak memory on one node from sstat (task
+// RSS times tasks per node), 0 if unknown.
+inline bool oversizedMemory(const api::NodeAllocation& node, long long node_rss_bytes) {
+    long long used_mb = node_rss_bytes / (1024 * 1024);
+    return node_rss_bytes > 0 && node.mem_mb > OVERSIZED_MEMORY * std::max(1LL, used_mb) && node.mem_mb - used_mb > 1024;
+}
+
+// Memory of the node as a bar: ours, other jobs', unallocated.
+inline ftxui::Element memoryGauge(const api::NodeAllocation& node, int bar_width) {
+    using namespace ftxui;
+
+    if (node.real_memory_mb <= 0) return text("?") | dim;
+
+    auto cells = [&](long long mb) { return (int)std::min<long long>(bar_width, (mb * bar_width + node.real_memory_mb / 2) / node.real_memory_mb); };
+    int ours = cells(node.mem_mb);
+    int others = std::min(bar_width - ours, cells(std::max(0LL, node.alloc_memory_mb - node.mem_mb)));
+
+    std::string ours_bar, others_bar;
+    for (int i = 0; i < ours; ++i) ours_bar += "■";
+    for (int i = 0; i < others; ++i) others_bar += "■";
+
+    return hbox({
+        text(ours_bar) | color(Color::Blue),
+        text(others_bar) | color(Color::Magenta),
+        text(std::string(bar_width - ours - others, '.')),
+    });
+}
+
+// Nodes nearly out of free memory, and nodes where the job asked for far
+// more than it uses, or nothing.
+inline ftxui::Element memoryWarnings(const api::DetailedJob& job, long long node_rss_bytes) {
+    using namespace ftxui;
+
+    int low = 0, oversized = 0;
+    long long asked = 0;
+    for (const auto& node : job.node_allocations) {
+        low += lowFreeMemory(node);
+        oversized += oversizedMemory(node, node_rss_bytes);
+        asked = std::max(asked, node.mem_mb);
+    }
+
+    std::vector<Element> lines;
+    if (low) {
+        lines.push_back(text("⚠ " + std::to_string(low) + " node(s) with under " +
+                             std::to_string((int)(LOW_FREE_MEMORY * 100)) + "% of memory free") | color(Color::Red));
+    }
+    if (oversized) {
+        lines.push_back(text("⚠ " + api::slurm::formatMemory(asked) + " per node requested, peak use per node " +
+                             api::slurm::formatMemory(node_rss_bytes / (1024 * 1024))) | color(Color::Yellow));
+    }
+    return lines.empty() ? emptyElement() : vbox(lines);
+}
+
+// Cores of node `i` held by other jobs, 0 without co-tenancy data.
+inline int otherCores(const api::DetailedJob& job, const std::vector<api::NodeTenancy>* tenancy, size_t i) {
+    if (!tenancy || i >= tenancy->size() || (*tenancy)[i].node_name != job.node_allocations[i].node_name) return 0;
+    return std::max(0, (*tenancy)[i].cpu_alloc - (int)job.node_allocations[i].allocated_cores.size());
+}
+
+// The jobs sharing one node with ours, largest first.
+inline ftxui::Element nodeTenants(const api::NodeTenancy& node, int ours) {
+    using namespace ftxui;
+    constexpr size_t max_rows = 8;
+
+    std::string load = node.cpu_load < 0 ? "?" : std::to_string((int)(node.cpu_load + 0.5));
+    std::vector<Element> lines;
+    lines.push_back(hbox({
+        text(node.node_name) | color(Color::BlueLight) | bold,
+        text("  " + std::to_string(node.cpu_alloc) + "/" + std::to_string(node.total_cores) + " cores allocated, "),
+        text(std::to_string(ours) + " ours") | color(Color::Blue),
+        text(", load " + load),
+    }));
+
+    if (node.tenants.empty()) lines.push_back(text("No other jobs on this node") | dim);
+    for (size_t i = 0; i < node.tenants.size() && i < max_rows; ++i) {
+        const auto& t = node.tenants[i];
+        lines.push_back(hbox({
+            text("■ ") | color(Color::Magenta),
+            text(t.job_id) | size(WIDTH, EQUAL, 14),
+            text(t.user) | size(WIDTH, EQUAL, 12),
+            text(std::to_string(t.cpus) + " cores") | size(WIDTH, EQUAL, 11),
+            text(t.name) | dim,
+        }));
+    }
+    if (node.tenants.size() > max_rows) {
+        lines.push_back(text("… " + std::to_string(node.tenants.size() - max_rows) + " more") | dim);
+    }
+
+    return vbox(lines) | border;
+}
+
+// Our share of the node's memory, red when the node is short of free
+// memory and yellow when we asked for far more than we use.
+inline ftxui::Element memoryPercent(const api::NodeAllocation& node, long long node_rss_bytes) {
+    using namespace ftxui;
+
+    if (node.real_memory_mb <= 0) return text("M ?") | dim;
+    Element e = text("M " + std::to_string((int)(node.mem_mb * 100 / node.real_memory_mb)) + "%");
+    if (lowFreeMemory(node)) return e | color(Color::Red);
+    if (oversizedMemory(node, node_rss_bytes)) return e | color(Color::Yellow);
+    return e | dim;
+}
+
+// One line per node: occupancy bar, core count and GPU dots, busiest nodes
+// first. Used when the per-core cells would not fit on a screen. Cores of
+// other jobs follow ours in the bar.
+inline ftxui::Element nodeSummary(const api::DetailedJob& job, int width,
+                                  const std::vector<api::NodeTenancy>* tenancy = nullptr, int selected_node = -1,
+                                  long long node_rss_bytes = 0) {
+    using namespace ftxui;
+
+    const int cell_width = 74;
+    const int bar_width = 20;
+    int nodes_per_row = std::max(1, width / cell_width);
+
+    struct Line {
+        const api::NodeAllocation* node;
+        int used;
+        int others;
+        float load;
+        bool selected;
+        bool warn;
+    };
+
+    std::vector<Line> lines;
+    lines.reserve(job.node_allocations.size());
+
+    long used_total = 0, cores_total = 0;
+    for (size_t i = 0; i < job.node_allocations.size(); ++i) {
+        const auto& node = job.node_allocations[i];
+        auto used = coreBitmap(node);
+        int count = std::count(used.begin(), used.end(), true);
+        int others = std::min(otherCores(job, tenancy, i), std::max(0, node.total_cores - count));
+        lines.push_back({&node, count, others, node.total_cores > 0 ? float(count) / node.total_cores : 0.f, (int)i == selected_node,
+                         api::placement(node).warn()});
+        used_total += count;
+        cores_total += node.total_cores;
+    }
+
+    std::stable_sort(lines.begin(), lines.end(), [](const Line& a, const Line& b) { return a.load > b.load; });
+
+    std::vector<std::vector<Element>> rows;
+    std::vector<Element> row;
+
+    for (const auto& line : lines) {
+        int filled = int(line.load * bar_width + 0.5f);
+        int shared = line.node->total_cores > 0 ? int(float(line.others) / line.node->total_cores * bar_width + 0.5f) : 0;
+        shared = std::min(shared, bar_width - filled);
+
+        std::vector<Element> gpus;
+        auto owned = gpuBitmap(*line.node);
+        for (int i = 0; i < line.node->total_gpus; ++i) {
+            if (owned[i])
+                gpus.push_back(text("●") | color(Color::Blue));
+            else
+                gpus.push_back(text("○"));
+        }
+        if (line.node->total_gpus == 0) gpus.push_back(text("-") | dim);
+
+        std::string bar, other_bar;
+        for (int i = 0; i < filled; ++i) bar += "■";
+        for (int i = 0; i < shared; ++i) other_bar += "■";
+
+        Element name = text(line.node->node_name) | color(Color::BlueLight) | bold;
+        if (line.selected) name = name | inverted;
+
+        row.push_back(hbox({
+            name | size(WIDTH, EQUAL, 16),
+            text(line.warn ? "⚠ " : "  ") | color(Color::Yellow),
+            text(bar) | color(Color::Blue),
+            text(other_bar) | color(Color::Magenta),
+            text(std::string(bar_width - filled - shared, '.')),
+            text(" " + std::to_string(line.used) + "/" + std::to_string(line.node->total_cores)) | size(WIDTH, EQUAL, 10),
+            memoryPercent(*line.node, node_rss_bytes) | size(WIDTH, EQUAL, 8),
+            hbox(gpus),
+        }) | size(WIDTH, EQUAL, cell_width));
+
+        if ((int)row.size() == nodes_per_row) {
+            rows.push_back(row);
+            row.clear();
+        }
+    }
+    if (!row.empty()) rows.push_back(row);
+
+    int percent = cores_total > 0 ? int(used_total * 100 / cores_total) : 0;
+
+    return vbox({
+        text(std::to_string(lines.size()) + " nodes, " + std::to_string(used_total) + "/" +
+             std::to_string(cores_total) + " cores (" + std::to_string(percent) + "%), busiest first") | dim,
+        text(""),
+        gridbox(rows),
+    });
+}
+
+// Nodes whose allocation is split across sockets, packs sibling threads or
+// uses GPUs on other sockets than its cores, or nothing when all is clean.
+inline ftxui::Element placementWarnings(const api::DetailedJob& job) {
     using namespace ftxui;
 
-    return Renderer([job, width] {
+    int split = 0, packed = 0, remote = 0;
+    for (const auto& node : job.node_allocations) {
+        auto p = api::placement(node);
+        split += p.split;
+        packed += p.packed_cores > 0;
+        remote += !p.remote_gpus.empty();
+    }
+
+    std::vector<std::string> parts;
+    if (split) parts.push_back(std::to_string(split) + " node(s) split across sockets");
+    if (packed) parts.push_back(std::to_string(packed) + " node(s) with hyperthread siblings packed");
+    if (remote) parts.push_back(std::to_string(remote) + " node(s) with GPUs far from their cores");
+    if (parts.empty()) return emptyElement();
+
+    std::string warning = "⚠ ";
+    for (size_t i = 0; i < parts.size(); ++i) warning += (i ? ", " : "") + parts[i];
+    return text(warning) | color(Color::Yellow);
+}
+
+// Per-core map of each node, one block per socket; cores with only some of
+// their threads allocated are half filled. With `tenancy` (see slurm::getNodeTenancy),
+// cores held by other jobs are drawn in their own colour on the free cells
+// (Slurm does not tell which ones they are) and `selected_node` is
+// highlighted.
+inline ftxui::Component nodedetails(const api::DetailedJob& job, int width,
+                                    std::shared_ptr<const std::vector<api::NodeTenancy>> tenancy = nullptr,
+                                    int selected_node = -1, long long node_rss_bytes = 0) {
+    using namespace ftxui;
+
+    return Renderer([job, width, tenancy, selected_node, node_rss_bytes] {
         std::vector<std::vector<Element>> rows;
         std::vector<Element> row;
 
         const int cell_width = 46;
+        const int cores_per_line = 20;
+        const int summary_lines = 40;
         int nodes_per_row = std::max(1, width / cell_width);
         int count = 0;
 
+        Element warnings = vbox({placementWarnings(job), memoryWarnings(job, node_rss_bytes)});
+
+        // Per-core cells grow with cores x nodes; past a screenful switch to
+        // the one-line-per-node summary.
+        int max_lines = 0;
         for (const auto& node : job.node_allocations) {
+            auto p = api::placement(node);
+            max_lines = std::max(max_lines, p.sockets * ((p.cores_per_socket + cores_per_line - 1) / cores_per_line));
+        }
+        int cell_rows = (job.node_allocations.size() + nodes_per_row - 1) / nodes_per_row;
+        int cell_lines = max_lines + 6;
+        if (cell_rows * cell_lines > summary_lines) {
+            return vbox({warnings, nodeSummary(job, width, tenancy.get(), selected_node, node_rss_bytes)});
+        }
+
+        for (size_t n = 0; n < job.node_allocations.size(); ++n) {
+            const auto& node = job.node_allocations[n];
             Element title = text(node.node_name) | color(Color::BlueLight) | bold;
+            if ((int)n == selected_node) title = title | inverted;
+
+            auto layout = api::placement(node);
+            // other jobs' CPUs, as whole cores
+            int others = otherCores(job, tenancy.get(), n) / layout.threads_per_core;
 
-            const int cores_per_line = 20;
-            int line_count = 0;
-            
             std::vector<Element> core_lines;
-            std::vector<Element> current_line;
+            for (int socket = 0; socket < layout.sockets; ++socket) {
+                std::string label = "S" + std::to_string(socket);
+                std::vector<Element> current_line = {text(label + std::string(7 - std::min<size_t>(6, label.size()), ' ') + ": ")};
+                int line_count = 0;
 
-            current_line.push_back(text("CPUs   : "));
+                for (int core = 0; core < layout.cores_per_socket; ++core) {
+                    int threads = layout.at(socket, core);
+                    if (threads >= layout.threads_per_core) {
+                        current_line.push_back(text("■") | color(Color::Blue));
+                    } else if (threads > 0) {
+                        current_line.push_back(text("▪") | color(Color::Blue));
+                    } else if (others > 0) {
+                        current_line.push_back(text("■") | color(Color::Magenta));
+                        --others;
+                    } else {
+                        current_line.push_back(text("."));
+                    }
 
-            for (int i = 0; i < node.total_cores; ++i) {
-                if (std::find(node.allocated_cores.begin(), node.allocated_cores.end(), i) != node.allocated_cores.end())
-                    current_line.push_back(text("■") | color(Color::Blue));
-                else
-                    current_line.push_back(text("."));
-
-                line_count++;
-                if (line_count == cores_per_line) {
-                    core_lines.push_back(hbox(current_line));
-                    current_line.clear();
-                    current_line.push_back(text("         "));
-                    line_count = 0;
+                    if (++line_count == cores_per_line) {
+                        core_lines.push_back(hbox(current_line));
+                        current_line = {text("         ")};
+                        line_count = 0;
+                    }
                 }
+
+                if (line_count > 0) core_lines.push_back(hbox(current_line));
             }
 
-            if (!current_line.empty()) {
-                core_lines.push_back(hbox(current_line));
+            std::string warning = api::placementWarning(layout);
+            if (!warning.empty()) core_lines.push_back(text("⚠ " + warning) | color(Color::Yellow));
+
+            Element mem_line = hbox({
+                text("Mem    : "),
+                memoryGauge(node, 16),
+                text(" " + api::slurm::formatMemory(node.mem_mb) + "/" + api::slurm::formatMemory(node.real_memory_mb)) | dim,
+            });
+            if (lowFreeMemory(node)) {
+                mem_line = vbox({mem_line, text("⚠ " + api::slurm::formatMemory(node.free_memory_mb) + " free on the node") | color(Color::Red)});
+            } else if (oversizedMemory(node, node_rss_bytes)) {
+                mem_line = vbox({mem_line, text("⚠ peak use per node " + api::slurm::formatMemory(node_rss_bytes / (1024 * 1024))) | color(Color::Yellow)});
             }
 
             Element cores_box = vbox(core_lines);
 
+            // our GPUs far from our cores in yellow
             std::vector<Element> gpu_line;
             gpu_line.push_back(text("GPUs   : "));
+            auto owned = gpuBitmap(node);
             for (int i = 0; i < node.total_gpus; ++i) {
-                if (i < node.allocated_gpus)
-                    gpu_line.push_back(text("● ") | color(Color::Blue));
+                bool remote = std::find(layout.remote_gpus.begin(), layout.remote_gpus.end(), i) != layout.remote_gpus.end();
+                if (owned[i])
+                    gpu_line.push_back(text("● ") | color(remote ? Color::Yellow : Color::Blue));
                 else
                     gpu_line.push_back(text("○ "));
             }
@@ -70,6 +368,7 @@ inline ftxui::Component nodedetails(const api::DetailedJob& job, int width) {
                     vbox({
                         title,
                         cores_box,
+                        mem_line,
                         text(" "),
                         gpu_box
                     }),
@@ -89,7 +388,7 @@ inline ftxui::Component nodedetails(const api::DetailedJob& job, int width) {
 
         if (!row.empty()) rows.push_back(row);
 
-        return gridbox(rows);
+        return vbox({warnings, gridbox(rows)});
     });
 }
 
@@ -49,4 +49,49 @@ inline Element cancelModal(const Element& base, const api::DetailedJob& job) {
     });
 }
 
+
+// Confirmation for the marked jobs; lists the first few and counts the rest.
+inline Element cancelManyModal(const Element& base, const std::vector<api::Job>& jobs) {
+    constexpr size_t SHOWN = 8;
+
+    std::string count = std::to_string(jobs.size()) + (jobs.size() == 1 ? " JOB" : " JOBS");
+    Element title = text("CANCEL " + count) | bold | color(Color::Red) | center;
+
+    Elements listed;
+    for (size_t i = 0; i < jobs.size() && i < SHOWN; ++i) {
+        listed.push_back(hbox({
+            text(jobs[i].isArray() ? jobs[i].id + "_[" + jobs[i].tasks + "]" : jobs[i].id) | bold | color(Color::Magenta),
+            text(" " + jobs[i].name + " "),
+            text(jobs[i].state) | dim,
+        }));
+    }
+    if (jobs.size() > SHOWN) {
+        listed.push_back(text("... and " + std::to_string(jobs.size() - SHOWN) + " more") | dim);
+    }
+
+    Element footer = hbox({
+        text("Y") | bold | color(Color::Green),
+        text(": YES  ") | dim,
+        text("N") | bold | color(Color::Red),
+        text(": NO") | dim,
+    }) | center;
+
+    return dbox({
+        base,
+        hbox({
+            text("   "),
+            vbox({
+                title,
+                text(""),
+                vbox(std::move(listed)),
+                text(""),
+                text("This action is undoable.") | bold | center,
+                text(""),
+                footer
+            }),
+            text("   ")
+        }) | border | clear_under | center,
+    });
+}
+
 }
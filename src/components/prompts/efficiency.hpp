@@ -0,0 +1,105 @@
+#pragma once
+
+#include <ftxui/component/component.hpp>
+#include <ftxui/dom/elements.hpp>
+#include <cstdio>
+#include <memory>
+
+#include "../../api/efficiency.hpp"
+
+namespace ui {
+using namespace ftxui;
+
+inline Element efficiencyCell(float ratio, int width) {
+    if (ratio < 0) return text("-") | dim | size(WIDTH, EQUAL, width);
+
+    Color c = ratio < 0.25f ? Color::Red : ratio < 0.6f ? Color::Yellow : Color::Green;
+    return text(std::to_string((int)(ratio * 100 + 0.5f)) + "%") | color(c) | size(WIDTH, EQUAL, width);
+}
+
+// Memory above the request (jobs that nearly or did run out) stands out
+// instead of looking efficient.
+inline Element memoryCell(float ratio, int width) {
+    if (ratio > 0.95f) return text(std::to_string((int)(ratio * 100 + 0.5f)) + "%") | color(Color::Magenta) | size(WIDTH, EQUAL, width);
+    return efficiencyCell(ratio, width);
+}
+
+// Efficiency of the finished jobs of the last month, grouped by job name,
+// partition or account; Tab switches the grouping.
+inline Component efficiencyModal(std::shared_ptr<api::EfficiencyTable> table, std::shared_ptr<api::EfficiencyBy> by, int width) {
+    return Renderer([=] {
+        constexpr int max_rows = 20;
+        auto groups = api::efficiency::summarize(*table, *by);
+
+        std::vector<Element> rows;
+        rows.push_back(hbox({
+            text(*by == api::EfficiencyBy::Name ? "JOB NAME" : *by == api::EfficiencyBy::Partition ? "PARTITION" : "ACCOUNT")
+                | bold | size(WIDTH, EQUAL, 32),
+            text("JOBS") | bold | size(WIDTH, EQUAL, 7),
+            text("CPU p50") | bold | size(WIDTH, EQUAL, 9),
+            text("CPU p90") | bold | size(WIDTH, EQUAL, 9),
+            text("MEM p50") | bold | size(WIDTH, EQUAL, 9),
+            text("MEM p90") | bold | size(WIDTH, EQUAL, 9),
+            text("WASTED CORE-H") | bold,
+        }));
+        rows.push_back(separator());
+
+        for (size_t i = 0; i < groups.size() && i < (size_t)max_rows; ++i) {
+            const auto& g = groups[i];
+            char wasted[32];
+            std::snprintf(wasted, sizeof(wasted), "%.1f", g.wasted_core_hours);
+
+            std::string key = g.key.size() > 30 ? g.key.substr(0, 29) + "…" : g.key;
+            rows.push_back(hbox({
+                text(key) | color(Color::BlueLight) | size(WIDTH, EQUAL, 32),
+                text(std::to_string(g.jobs)) | size(WIDTH, EQUAL, 7),
+                efficiencyCell(g.cpu_p50, 9),
+                efficiencyCell(g.cpu_p90, 9),
+                memoryCell(g.mem_p50, 9),
+                memoryCell(g.mem_p90, 9),
+                text(wasted),
+            }));
+        }
+
+        if (groups.empty() && table->loading()) {
+            rows.push_back(text("Querying sacct…") | dim);
+        } else if (groups.empty()) {
+            rows.push_back(text("No finished jobs in the last 30 days") | dim);
+        } else if (groups.size() > (size_t)max_rows) {
+            rows.push_back(text("… " + std::to_string(groups.size() - max_rows) + " more") | dim);
+        }
+
+        auto tab = [&](api::EfficiencyBy value, const std::string& label) {
+            return *by == value ? text(label) | bold | color(Color::Blue) : text(label) | dim;
+        };
+
+        Element selector = hbox({
+            tab(api::EfficiencyBy::Name, "[name]"),
+            text("  "),
+            tab(api::EfficiencyBy::Partition, "[partition]"),
+            text("  "),
+            tab(api::EfficiencyBy::Account, "[account]"),
+            filler(),
+            table->loading()
+                ? text("loading " + std::to_string(table->windows_done) + "/" + (table->windows ? std::to_string(table->windows) : "?") + " days  ") | color(Color::Yellow)
+                : text(""),
+            text(std::to_string(table->size()) + " jobs") | dim,
+        });
+
+        return vbox({
+            text("JOB EFFICIENCY (30 days)") | bold | center,
+            text(""),
+            hbox({text("  "), selector, text("  ")}),
+            separator(),
+            hbox({text("  "), vbox(rows), text("  ")}),
+            text(""),
+            hbox({text("  "),
+                  text("CPU: TotalCPU / (Elapsed × CPUs)   MEM: peak MaxRSS × tasks per node / requested per node") | dim,
+                  text("  ")}),
+            text(""),
+            text("Tab: group by name/partition/account   Any key: close") | dim | center,
+        }) | border | size(WIDTH, LESS_THAN, width - 4) | clear_under | center;
+    });
+}
+
+}
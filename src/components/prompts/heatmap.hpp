@@ -0,0 +1,181 @@
+#pragma once
+
+#include <ftxui/component/component.hpp>
+#include <ftxui/dom/elements.hpp>
+#include <map>
+
+#include "../../api/slurmjobs.hpp"
+#include "../nodedetails.hpp"
+
+namespace ui {
+using namespace ftxui;
+
+struct HeatCell {
+    const char* glyph;
+    Color color;
+};
+
+inline HeatCell heatCell(const api::ClusterNodes& cluster, size_t i) {
+    switch (cluster.state[i]) {
+        case api::NodeState::Down:  return {"x", Color::GrayDark};
+        case api::NodeState::Drain: return {"x", Color::Magenta};
+        default: break;
+    }
+
+    float cpu = cluster.cpu_total[i] > 0 ? (float)cluster.cpu_alloc[i] / cluster.cpu_total[i] : 0.f;
+    float gpu = cluster.gpu_total[i] > 0 ? (float)cluster.gpu_used[i] / cluster.gpu_total[i] : 0.f;
+    float load = std::max(cpu, gpu);
+
+    if (load <= 0.f)  return {"·", Color::Green};
+    if (load < 0.25f) return {"░", Color::GreenLight};
+    if (load < 0.50f) return {"▒", Color::Yellow};
+    if (load < 1.00f) return {"▓", Color::YellowLight};
+    return {"█", Color::Red};
+}
+
+// Short of free memory, by the threshold of the job view.
+inline bool lowFreeMemory(const api::ClusterNodes& cluster, size_t i) {
+    return cluster.mem_free[i] >= 0 && cluster.mem_total[i] > 0 &&
+           cluster.mem_free[i] < cluster.mem_total[i] * LOW_FREE_MEMORY;
+}
+
+// Node name without its trailing index, e.g. "romeo-a045" -> "romeo-a".
+inline std::string apuGroup(const std::string& node_name) {
+    size_t end = node_name.find_last_not_of("0123456789");
+    return end == std::string::npos ? node_name : node_name.substr(0, end + 1);
+}
+
+// Glyphs of consecutive nodes sharing a colour are merged into one text
+// element, so a 2000 node cluster renders as a few hundred elements.
+inline Element renderHeatRow(const api::ClusterNodes& cluster, const std::vector<int>& nodes, size_t from, size_t to) {
+    std::vector<Element> runs;
+    std::string run;
+    Color run_color = Color::Default;
+
+    for (size_t k = from; k < to; ++k) {
+        HeatCell cell = heatCell(cluster, nodes[k]);
+        if (!run.empty() && !(cell.color == run_color)) {
+            runs.push_back(text(run) | color(run_color));
+            run.clear();
+        }
+        run += cell.glyph;
+        run_color = cell.color;
+    }
+    if (!run.empty()) runs.push_back(text(run) | color(run_color));
+
+    return hbox(runs);
+}
+
+// `scroll_y` is the relative position (0 top, 1 bottom) of the node rows,
+// moved by the caller on arrows and the mouse wheel.
+inline Component heatmapModal(std::shared_ptr<api::ClusterNodes> cluster, std::shared_ptr<bool> by_apu,
+                              std::shared_ptr<float> scroll_y, int width) {
+    return Renderer([=] {
+        std::map<std::string, std::vector<int>> groups;
+
+        for (size_t i = 0; i < cluster->size(); ++i) {
+            if (*by_apu) {
+                groups[apuGroup(cluster->names[i])].push_back(i);
+                continue;
+            }
+
+            const std::string& parts = cluster->partitions[i];
+            if (parts.empty()) {
+                groups["(none)"].push_back(i);
+                continue;
+            }
+
+            size_t pos = 0;
+            while (pos <= parts.size()) {
+                size_t end = parts.find(',', pos);
+                if (end == std::string::npos) end = parts.size();
+                groups[parts.substr(pos, end - pos)].push_back(i);
+                pos = end + 1;
+            }
+        }
+
+        const int cells_per_row = std::max(10, width - 12);
+
+        std::vector<Element> rows;
+        for (const auto& [name, nodes] : groups) {
+            long cpu_alloc = 0, cpu_total = 0, gpu_used = 0, gpu_total = 0;
+            long long mem_alloc = 0, mem_total = 0;
+            int low_memory = 0;
+            for (int i : nodes) {
+                cpu_alloc += cluster->cpu_alloc[i];
+                cpu_total += cluster->cpu_total[i];
+                gpu_used  += cluster->gpu_used[i];
+                gpu_total += cluster->gpu_total[i];
+                mem_alloc += cluster->mem_alloc[i];
+                mem_total += cluster->mem_total[i];
+                low_memory += lowFreeMemory(*cluster, i);
+            }
+
+            std::vector<Element> stats = {
+                text(name) | bold | color(Color::BlueLight) | size(WIDTH, EQUAL, 20),
+                text(std::to_string(nodes.size()) + " nodes") | size(WIDTH, EQUAL, 12),
+                text("CPU " + std::to_string(cpu_alloc) + "/" + std::to_string(cpu_total)) | dim | size(WIDTH, EQUAL, 22),
+            };
+            if (mem_total > 0) {
+                stats.push_back(text("MEM " + api::slurm::formatMemory(mem_alloc) + "/" + api::slurm::formatMemory(mem_total)) | dim | size(WIDTH, EQUAL, 22));
+            }
+            if (gpu_total > 0) {
+                stats.push_back(text("GPU " + std::to_string(gpu_used) + "/" + std::to_string(gpu_total)) | dim | size(WIDTH, EQUAL, 14));
+            }
+            if (low_memory > 0) {
+                stats.push_back(text(std::to_string(low_memory) + " low on memory") | color(Color::Red));
+            }
+            rows.push_back(hbox(stats));
+
+            for (size_t from = 0; from < nodes.size(); from += cells_per_row) {
+                size_t to = std::min(nodes.size(), from + (size_t)cells_per_row);
+                rows.push_back(renderHeatRow(*cluster, nodes, from, to));
+            }
+            rows.push_back(text(""));
+        }
+
+        if (groups.empty()) {
+            rows.push_back(text("No nodes reported by scontrol") | dim);
+        }
+
+        Element legend = hbox({
+            text("Legend: ") | dim,
+            text("·") | color(Color::Green), text(" idle  ") | dim,
+            text("░") | color(Color::GreenLight), text(" <25%  ") | dim,
+            text("▒") | color(Color::Yellow), text(" <50%  ") | dim,
+            text("▓") | color(Color::YellowLight), text(" <100%  ") | dim,
+            text("█") | color(Color::Red), text(" full  ") | dim,
+            text("x") | color(Color::Magenta), text(" drain  ") | dim,
+            text("x") | color(Color::GrayDark), text(" down") | dim,
+        });
+
+        long long mem_alloc = 0, mem_total = 0;
+        for (size_t i = 0; i < cluster->size(); ++i) {
+            mem_alloc += cluster->mem_alloc[i];
+            mem_total += cluster->mem_total[i];
+        }
+
+        Element selector = hbox({
+            (*by_apu ? text("[partition]") | dim : text("[partition]") | bold | color(Color::Blue)),
+            text("  "),
+            (*by_apu ? text("[APU type]") | bold | color(Color::Blue) : text("[APU type]") | dim),
+            filler(),
+            mem_total > 0 ? text("memory " + api::slurm::formatMemory(mem_alloc) + "/" + api::slurm::formatMemory(mem_total) + " allocated   ") | dim
+                          : text(""),
+            text(std::to_string(cluster->size()) + " nodes") | dim,
+        });
+
+        return vbox({
+            text("CLUSTER NODES") | bold | center,
+            text(""),
+            hbox({text("  "), selector, text("  ")}),
+            separator(),
+            hbox({text("  "), vbox(rows) | focusPositionRelative(0.f, *scroll_y) | frame | flex, text("  ")}) | flex,
+            hbox({text("  "), legend, text("  ")}),
+            text(""),
+            text("Arrows/Wheel: scroll   Tab: group by partition/APU type   Any key: close") | dim | center,
+        }) | border | size(WIDTH, LESS_THAN, width - 4) | clear_under | center;
+    });
+}
+
+}
@@ -14,6 +14,7 @@ inline ftxui::Component helpModal(std::function<void()> on_close) {
             text(""),
             text("Navigation") | bold | color(Color::BlueLight),
             hbox({text("  Arrows          "), text("Navigate job list") | dim}),
+            hbox({text("  Enter           "), text("Expand/collapse a job array") | dim}),
             hbox({text("  Wheel           "), text("Scroll details/logs") | dim}),
             text(""),
         });
@@ -22,17 +23,26 @@ inline ftxui::Component helpModal(std::function<void()> on_close) {
             text(""),
             text("Actions") | bold | color(Color::BlueLight),
             hbox({text("  r               "), text("Refresh jobs") | dim}),
-            hbox({text("  c               "), text("Cancel job (with confirmation)") | dim}),
+            hbox({text("  c               "), text("Cancel job, or all marked jobs (with confirmation)") | dim}),
+            hbox({text("  Space           "), text("Mark/unmark job") | dim}),
+            hbox({text("  m               "), text("Mark by name/id glob or state:PENDING") | dim}),
+            hbox({text("  x               "), text("Clear marks") | dim}),
+            hbox({text("  t               "), text("Pin/unpin job to the dashboard") | dim}),
             text(""),
         });
 
         Element help_box_3 = vbox({
             text(""),
             text("Views") | bold | color(Color::BlueLight),
-            hbox({text("  p               "), text("Partitions view (sinfo)") | dim}),
-            hbox({text("  l               "), text("Logs view (stdout/stderr, scrollable)") | dim}),
+            hbox({text("  p               "), text("Partitions view (sinfo), p50/p90 queue wait for jobs like the selected one") | dim}),
+            hbox({text("  n               "), text("Cluster node heatmap (scontrol)") | dim}),
+            hbox({text("  s               "), text("Steps of the job (sacct/sstat), longest srun step marked") | dim}),
+            hbox({text("  l               "), text("Logs view (stdout/stderr, arrays merged, PgUp/PgDn/Home/End)") | dim}),
             hbox({text("  a               "), text("History (sacct) - filter with ←→") | dim}),
             hbox({text("  u               "), text("User quota (sacctmgr limits)") | dim}),
+            hbox({text("  e               "), text("Job efficiency over 30 days (CPU/memory percentiles)") | dim}),
+            hbox({text("  d               "), text("Dashboard of pinned jobs, side by side") | dim}),
+            hbox({text("  o / [ ]         "), text("Other jobs on the job's nodes / select a node") | dim}),
             text(""),
         });
 
@@ -40,6 +50,7 @@ inline ftxui::Component helpModal(std::function<void()> on_close) {
             text(""),
             text("Other") | bold | color(Color::BlueLight),
             hbox({text("  h / ?           "), text("Show this help") | dim}),
+            hbox({text("  F12             "), text("Latency stats (exec/parse/frame)") | dim}),
             hbox({text("  q / Escape      "), text("Quit application") | dim}),
             text(""),
             text(""),
@@ -2,87 +2,93 @@
 
 #include <ftxui/component/component.hpp>
 #include <ftxui/dom/elements.hpp>
-#include <fstream>
-#include <sstream>
 #include <algorithm>
+#include <memory>
 
 #include "../../api/slurmjobs.hpp"
+#include "../../api/mergedlog.hpp"
 
 namespace ui {
 using namespace ftxui;
 
-inline std::vector<std::string> readLogFileLines(const std::string& path, int max_lines = 500) {
-    std::vector<std::string> lines;
-
-    if (path.empty() || path == "(null)") {
-        lines.push_back("[File not specified]");
-        return lines;
-    }
-
-    std::ifstream file(path);
-    if (!file.is_open()) {
-        lines.push_back("[Cannot open: " + path + "]");
-        return lines;
-    }
-
-    std::string line;
-    while (std::getline(file, line)) {
-        lines.push_back(line);
-    }
-
-    if (lines.empty()) {
-        lines.push_back("[Empty file]");
-        return lines;
-    }
-
-    if (lines.size() > (size_t)max_lines) {
-        lines.erase(lines.begin(), lines.end() - max_lines);
-    }
+// Log modal of a job. Array and het jobs get the logs of every task or
+// component merged into one view, with a column naming the source of each
+// line; only the lines on screen are read. A single log opens at its end,
+// where a running job is writing.
+inline Component logModal(const api::DetailedJob& job, std::shared_ptr<bool> show_stderr, std::function<void()> on_close) {
+    constexpr int view_height = 25;
+
+    struct State {
+        std::vector<api::LogSource> sources;
+        std::unique_ptr<api::MergedLog> stdout_log;
+        std::unique_ptr<api::MergedLog> stderr_log;
+        size_t top = 0;
+
+        size_t tail(bool stderr_side) {
+            if (sources.size() != 1) return 0;
+            size_t total = current(stderr_side).size();
+            return total > (size_t)view_height ? total - view_height : 0;
+        }
 
-    return lines;
-}
+        api::MergedLog& current(bool stderr_side) {
+            auto& log = stderr_side ? stderr_log : stdout_log;
+            if (!log) {
+                std::vector<std::string> paths;
+                for (const auto& s : sources) paths.push_back(stderr_side ? s.stderr_path : s.stdout_path);
+                log = std::make_unique<api::MergedLog>(paths);
+            }
+            return *log;
+        }
+    };
 
-inline Component logModal(const api::DetailedJob& job, std::shared_ptr<bool> show_stderr, std::shared_ptr<float> scroll_y, std::function<void()> on_close) {
-    auto paths = api::slurm::getJobLogPaths(job.id);
+    auto state = std::make_shared<State>();
+    state->sources = api::slurm::getJobLogSources(job.id);
+    state->top = state->tail(*show_stderr);
 
-    auto stdout_path = std::make_shared<std::string>(paths.first);
-    auto stderr_path = std::make_shared<std::string>(paths.second);
-    auto stdout_lines = std::make_shared<std::vector<std::string>>(readLogFileLines(*stdout_path));
-    auto stderr_lines = std::make_shared<std::vector<std::string>>(readLogFileLines(*stderr_path));
+    const std::vector<Color> source_colors = {
+        Color::Cyan, Color::Yellow, Color::Green, Color::Magenta, Color::Blue, Color::Red,
+    };
 
     auto log_content = Renderer([=] {
-        std::vector<Element> log_elements;
-        auto& lines = *show_stderr ? *stderr_lines : *stdout_lines;
+        auto& log = state->current(*show_stderr);
+        bool many = state->sources.size() > 1;
 
-        int line_num = 1;
-        for (const auto& line : lines) {
-            std::string display_line = line;
+        std::vector<Element> log_elements;
+        size_t line_num = state->top + 1;
+        for (const auto& line : log.window(state->top, view_height)) {
+            std::string display_line(line.text);
             if (display_line.length() > 120) {
                 display_line = display_line.substr(0, 117) + "...";
             }
-            log_elements.push_back(hbox({
-                text(std::to_string(line_num)) | dim | size(WIDTH, EQUAL, 5),
-                text(" "),
-                text(display_line),
-            }));
+
+            Elements row = {text(std::to_string(line_num)) | dim | size(WIDTH, EQUAL, 7)};
+            if (many) {
+                row.push_back(text(state->sources[line.source].label) | size(WIDTH, EQUAL, 6) |
+                              color(source_colors[line.source % source_colors.size()]));
+            }
+            row.push_back(text(" "));
+            row.push_back(text(display_line));
+            log_elements.push_back(hbox(row));
             line_num++;
         }
 
+        if (log_elements.empty()) {
+            if (state->sources.empty()) log_elements.push_back(text("[File not specified]") | dim);
+            else if (log.missing() == (int)state->sources.size()) log_elements.push_back(text("[Cannot open log]") | dim);
+            else log_elements.push_back(text("[Empty file]") | dim);
+        }
+
         return vbox(log_elements);
     });
 
     auto scrollable_content = Renderer(log_content, [=] {
         return log_content->Render()
-               | focusPositionRelative(0.f, *scroll_y)
-               | frame
-               | size(HEIGHT, EQUAL, 25) | size(WIDTH, EQUAL, 120);
+               | size(HEIGHT, EQUAL, view_height) | size(WIDTH, EQUAL, 135);
     });
 
     auto full_view = Renderer(scrollable_content, [=] {
-        std::string current_path = *show_stderr ? *stderr_path : *stdout_path;
-        auto& lines = *show_stderr ? *stderr_lines : *stdout_lines;
-        int total_lines = lines.size();
-        int scroll_percent = (int)(*scroll_y * 100);
+        auto& log = state->current(*show_stderr);
+        size_t known = log.knownLines();
 
         Element title = hbox({
             text("LOGS: ") | bold,
@@ -91,6 +97,9 @@ inline Component logModal(const api::DetailedJob& job, std::shared_ptr<bool> sho
             text(")") | bold
         }) | center;
 
+        std::string lines_text = log.isComplete() ? std::to_string(known) + " lines"
+                                                  : std::to_string(known) + "+ lines";
+
         Element selector = hbox({
             (*show_stderr ? text("[stdout]") | dim : text("[stdout]") | bold | color(Color::Blue)),
             text("  "),
@@ -98,19 +107,35 @@ inline Component logModal(const api::DetailedJob& job, std::shared_ptr<bool> sho
             text("  "),
             (*show_stderr ? text("[stderr]") | bold | color(Color::Blue) : text("[stderr]") | dim),
             filler(),
-            text(std::to_string(total_lines) + " lines") | dim,
+            text(lines_text) | dim,
             text("  "),
-            text(std::to_string(scroll_percent) + "%") | color(Color::Blue),
+            text("line " + std::to_string(state->top + 1)) | color(Color::Blue),
         });
 
-        Element path = hbox({
-            text("File: ") | dim,
-            text(current_path),
-        });
+        Element path;
+        if (state->sources.size() > 1) {
+            int missing = log.missing();
+            path = hbox({
+                text("Files: ") | dim,
+                text(std::to_string(state->sources.size()) + " merged by timestamp"),
+                missing > 0 ? text("  (" + std::to_string(missing) + " missing)") | color(Color::Yellow) : text(""),
+            });
+        } else {
+            std::string current_path;
+            if (!state->sources.empty()) {
+                current_path = *show_stderr ? state->sources[0].stderr_path : state->sources[0].stdout_path;
+            }
+            path = hbox({
+                text("File: ") | dim,
+                text(current_path.empty() ? "(null)" : current_path),
+            });
+        }
 
         Element footer = hbox({
             text("Arrows/Wheel") | bold | color(Color::Blue),
             text(":scroll  ") | dim,
+            text("PgUp/PgDn/Home/End") | bold | color(Color::Blue),
+            text(":jump  ") | dim,
             text("Tab") | bold | color(Color::Blue),
             text(":stdout/stderr  ") | dim,
             text("Any") | bold | color(Color::Blue),
@@ -131,39 +156,68 @@ inline Component logModal(const api::DetailedJob& job, std::shared_ptr<bool> sho
                 scrollable_content->Render() | flex,
                 text(""),
                 footer
-                
             }),
             text("  ")
-        }) | border | size(WIDTH, LESS_THAN, 130);
+        }) | border | size(WIDTH, LESS_THAN, 145);
     });
 
     return CatchEvent(full_view, [=](Event e) {
-        constexpr float scroll_step = 0.05f;
+        auto scroll = [&](long delta) {
+            auto& log = state->current(*show_stderr);
+            long top = std::max(0L, (long)state->top + delta);
+            // only clamp against lines merged so far, so scrolling stays lazy
+            if (delta > 0) {
+                size_t reachable = log.window(top, 1).empty() ? log.knownLines() : (size_t)top + 1;
+                top = std::min<long>(top, std::max<long>(0, (long)reachable - 1));
+            }
+            state->top = top;
+        };
 
         if (e.is_mouse()) {
             if (e.mouse().button == Mouse::WheelDown) {
-                *scroll_y = std::min(*scroll_y + scroll_step, 1.f);
+                scroll(3);
                 return true;
             }
             if (e.mouse().button == Mouse::WheelUp) {
-                *scroll_y = std::max(*scroll_y - scroll_step, 0.f);
+                scroll(-3);
                 return true;
             }
         }
 
         else if (e == Event::ArrowDown) {
-            *scroll_y = std::min(*scroll_y + scroll_step, 1.f);
+            scroll(1);
             return true;
         }
 
         else if (e == Event::ArrowUp) {
-            *scroll_y = std::max(*scroll_y - scroll_step, 0.f);
+            scroll(-1);
+            return true;
+        }
+
+        else if (e == Event::PageDown) {
+            scroll(view_height);
+            return true;
+        }
+
+        else if (e == Event::PageUp) {
+            scroll(-view_height);
+            return true;
+        }
+
+        else if (e == Event::Home) {
+            state->top = 0;
+            return true;
+        }
+
+        else if (e == Event::End) {
+            size_t total = state->current(*show_stderr).size();
+            state->top = total > (size_t)view_height ? total - view_height : 0;
             return true;
         }
 
         else if (e == Event::Tab || e == Event::TabReverse) {
             *show_stderr = !*show_stderr;
-            *scroll_y = 0.f; 
+            state->top = state->tail(*show_stderr);
             return true;
         }
 
@@ -171,7 +225,7 @@ inline Component logModal(const api::DetailedJob& job, std::shared_ptr<bool> sho
             on_close();
             return true;
         }
-        
+
         return false;
     });
 }
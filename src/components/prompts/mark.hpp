@@ -0,0 +1,67 @@
+#pragma once
+
+#include <ftxui/component/component.hpp>
+#include <ftxui/dom/elements.hpp>
+
+#include <cctype>
+#include <string>
+
+#include "../../api/slurmjobs.hpp"
+
+namespace ui {
+using namespace ftxui;
+
+// Shell-style glob with `*` and `?`, case-insensitive.
+inline bool globMatch(const std::string& pattern, const std::string& value) {
+    size_t p = 0, v = 0, star = std::string::npos, resume = 0;
+
+    while (v < value.size()) {
+        if (p < pattern.size() && (pattern[p] == '?' ||
+            std::tolower((unsigned char)pattern[p]) == std::tolower((unsigned char)value[v]))) {
+            ++p;
+            ++v;
+        } else if (p < pattern.size() && pattern[p] == '*') {
+            star = p++;
+            resume = v;
+        } else if (star != std::string::npos) {
+            p = star + 1;
+            v = ++resume;
+        } else {
+            return false;
+        }
+    }
+
+    while (p < pattern.size() && pattern[p] == '*') ++p;
+    return p == pattern.size();
+}
+
+// "state:<glob>" matches the squeue state (PENDING, RUNNING...), anything
+// else is a glob on the job name or id.
+inline bool markMatches(const api::Job& job, const std::string& pattern) {
+    const std::string state_prefix = "state:";
+    if (pattern.compare(0, state_prefix.size(), state_prefix) == 0) {
+        return globMatch(pattern.substr(state_prefix.size()), job.state);
+    }
+    return globMatch(pattern, job.name) || globMatch(pattern, job.id);
+}
+
+inline Component markModal(std::string* pattern) {
+    Component input = Input(pattern, "name glob, id or state:PENDING");
+
+    return Renderer(input, [input] {
+        return vbox({
+            text("MARK JOBS") | bold | center,
+            text(""),
+            hbox({text(" Pattern: "), input->Render() | size(WIDTH, EQUAL, 36)}),
+            text(""),
+            hbox({
+                text("Enter") | bold | color(Color::Green),
+                text(": mark matching  ") | dim,
+                text("Esc") | bold | color(Color::Red),
+                text(": close") | dim,
+            }) | center,
+        }) | border;
+    });
+}
+
+}
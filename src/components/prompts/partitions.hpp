@@ -2,17 +2,35 @@
 
 #include <ftxui/component/component.hpp>
 #include <ftxui/dom/elements.hpp>
+#include <cstdio>
+#include <memory>
+#include "../../api/queuewait.hpp"
 #include "../../api/slurmjobs.hpp"
 
 namespace ui {
 using namespace ftxui;
 
+// Cores when sinfo reported them (idle / allocated / offline), node states
+// otherwise.
 inline Element renderPartitionBar(const api::PartitionInfo& p) {
+    const int bar_width = 30;
+
+    if (p.cpus_total > 0) {
+        int idle_w = (long(p.cpus_idle) * bar_width) / p.cpus_total;
+        int alloc_w = (long(p.cpus_alloc) * bar_width) / p.cpus_total;
+        int other_w = std::max(0, bar_width - idle_w - alloc_w);
+
+        std::vector<Element> bar_parts;
+        if (idle_w > 0) bar_parts.push_back(text(std::string(idle_w, '=')) | color(Color::Green));
+        if (alloc_w > 0) bar_parts.push_back(text(std::string(alloc_w, '=')) | color(Color::Red));
+        if (other_w > 0) bar_parts.push_back(text(std::string(other_w, 'x')) | color(Color::GrayDark));
+
+        return hbox(bar_parts);
+    }
+
     int total = p.nodes_total;
     if (total == 0) total = 1;
 
-    const int bar_width = 30;
-
     int idle_w = (p.nodes_idle * bar_width) / total;
     int mix_w = (p.nodes_mix * bar_width) / total;
     int alloc_w = (p.nodes_alloc * bar_width) / total;
@@ -28,12 +46,38 @@ inline Element renderPartitionBar(const api::PartitionInfo& p) {
     return hbox(bar_parts);
 }
 
-inline Component paritionsModal() {
-    return Renderer([] {
-        auto partitions = api::slurm::getPartitions();
+// "<1m", "25m", "3.5h", "2.0d"; dim when it stands for the whole
+// partition rather than the asked shape.
+inline Element waitCell(double seconds, bool exact, int width) {
+    if (seconds < 0) return text("-") | dim | size(WIDTH, EQUAL, width);
 
+    char buf[32];
+    if (seconds < 60) std::snprintf(buf, sizeof(buf), "<1m");
+    else if (seconds < 3600) std::snprintf(buf, sizeof(buf), "%dm", (int)(seconds / 60 + 0.5));
+    else if (seconds < 86400) std::snprintf(buf, sizeof(buf), "%.1fh", seconds / 3600);
+    else std::snprintf(buf, sizeof(buf), "%.1fd", seconds / 86400);
+
+    Color c = seconds < 600 ? Color::Green : seconds < 7200 ? Color::Yellow : Color::Red;
+    Element cell = text(std::string(buf) + (exact ? "" : "*")) | color(c);
+    if (!exact) cell = cell | dim;
+    return cell | size(WIDTH, EQUAL, width);
+}
+
+// Renders the partitions fetched when the view was opened, with the queue
+// waits of past jobs shaped like `shape` (the selected job) when given.
+inline Component paritionsModal(std::shared_ptr<std::vector<api::PartitionInfo>> partitions,
+                                std::shared_ptr<api::QueueWaits> waits, const api::WaitShape* shape, bool updating) {
+    return Renderer([=] {
         std::vector<Element> rows;
 
+        std::vector<api::WaitStats> stats;
+        int shortest = -1;
+        for (const auto& p : *partitions) {
+            stats.push_back(waits->stats(p.name, shape));
+            const auto& s = stats.back();
+            if (p.state == "up" && s.p50 >= 0 && (shortest < 0 || s.p50 < stats[shortest].p50)) shortest = stats.size() - 1;
+        }
+
         rows.push_back(
             hbox({
                 text("PARTITION") | bold | size(WIDTH, EQUAL, 15),
@@ -42,13 +86,19 @@ inline Component paritionsModal() {
                 text("MIX") | bold | color(Color::Yellow) | size(WIDTH, EQUAL, 6),
                 text("ALLOC") | bold | color(Color::Red) | size(WIDTH, EQUAL, 6),
                 text("DOWN") | bold | color(Color::GrayDark) | size(WIDTH, EQUAL, 6),
+                text("FREE CPUS") | bold | size(WIDTH, EQUAL, 15),
+                text("FREE GPUS") | bold | size(WIDTH, EQUAL, 12),
                 text("LIMIT") | bold | size(WIDTH, EQUAL, 12),
+                text("WAIT p50") | bold | size(WIDTH, EQUAL, 10),
+                text("WAIT p90") | bold | size(WIDTH, EQUAL, 10),
                 text("USAGE") | bold,
             })
         );
         rows.push_back(separator());
 
-        for (const auto& p : partitions) {
+        for (size_t i = 0; i < partitions->size(); ++i) {
+            const auto& p = (*partitions)[i];
+            const auto& wait = stats[i];
             Color state_color = (p.state == "up") ? Color::Green : Color::Red;
 
             rows.push_back(hbox({
@@ -58,18 +108,28 @@ inline Component paritionsModal() {
                 text(std::to_string(p.nodes_mix)) | color(Color::Yellow) | size(WIDTH, EQUAL, 6),
                 text(std::to_string(p.nodes_alloc)) | color(Color::Red) | size(WIDTH, EQUAL, 6),
                 text(std::to_string(p.nodes_down)) | color(Color::GrayDark) | size(WIDTH, EQUAL, 6),
+                text(std::to_string(p.cpus_idle) + "/" + std::to_string(p.cpus_total)) | size(WIDTH, EQUAL, 15),
+                text(p.gpus_total > 0 ? std::to_string(p.gpus_total - p.gpus_used) + "/" + std::to_string(p.gpus_total) : "-")
+                    | size(WIDTH, EQUAL, 12),
                 text(p.timelimit) | dim | size(WIDTH, EQUAL, 12),
+                waitCell(wait.p50, wait.exact || !shape, 10),
+                waitCell(wait.p90, wait.exact || !shape, 10),
                 renderPartitionBar(p),
+                (int)i == shortest ? text(" ◀ shortest wait") | color(Color::Green) : text(""),
             }));
         }
 
         rows.push_back(text(""));
         rows.push_back(hbox({
             text("Legend: ") | dim,
-            text("=") | color(Color::Green), text(" idle  ") | dim,
-            text("=") | color(Color::Yellow), text(" mix  ") | dim,
-            text("=") | color(Color::Red), text(" alloc  ") | dim,
-            text("x") | color(Color::GrayDark), text(" down") | dim,
+            text("=") | color(Color::Green), text(" idle cores  ") | dim,
+            text("=") | color(Color::Red), text(" allocated  ") | dim,
+            text("x") | color(Color::GrayDark), text(" offline") | dim,
+        }));
+        rows.push_back(hbox({
+            text("WAIT: Start − Submit of your jobs") | dim,
+            text(shape ? " like the selected one (" + api::QueueWaits::shapeLabel(*shape) + "); * all shapes, too few like it" : "") | dim,
+            updating ? text("  updating from sacct…") | color(Color::Yellow) : text(""),
         }));
 
         return vbox({
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <ftxui/component/component.hpp>
+#include <ftxui/dom/elements.hpp>
+#include <cstdio>
+
+#include "../../api/stats.hpp"
+
+namespace ui {
+using namespace ftxui;
+
+inline std::string formatMs(double ms) {
+    char buf[32];
+    if (ms >= 1000) std::snprintf(buf, sizeof(buf), "%.2fs", ms / 1000);
+    else if (ms >= 10) std::snprintf(buf, sizeof(buf), "%.0fms", ms);
+    else std::snprintf(buf, sizeof(buf), "%.2fms", ms);
+    return buf;
+}
+
+inline std::string formatBytes(uint64_t bytes) {
+    char buf[32];
+    if (bytes >= (1u << 20)) std::snprintf(buf, sizeof(buf), "%.1fM", bytes / (1024.0 * 1024));
+    else if (bytes >= (1u << 10)) std::snprintf(buf, sizeof(buf), "%.1fK", bytes / 1024.0);
+    else std::snprintf(buf, sizeof(buf), "%lu", (unsigned long)bytes);
+    return buf;
+}
+
+inline Element statsModal() {
+    std::vector<Element> rows;
+
+    rows.push_back(hbox({
+        text("NAME") | bold | size(WIDTH, EQUAL, 30),
+        text("COUNT") | bold | size(WIDTH, EQUAL, 8),
+        text("P50") | bold | size(WIDTH, EQUAL, 10),
+        text("P99") | bold | size(WIDTH, EQUAL, 10),
+        text("MAX") | bold | size(WIDTH, EQUAL, 10),
+        text("READ") | bold | size(WIDTH, EQUAL, 8),
+    }));
+    rows.push_back(separator());
+
+    for (const auto& [name, h] : api::stats::all()) {
+        if (h->count() == 0) continue;
+
+        Color name_color = name.rfind("exec:", 0) == 0 ? Color::Yellow
+                         : name.rfind("parse:", 0) == 0 ? Color::BlueLight
+                         : Color::Green;
+
+        rows.push_back(hbox({
+            text(name) | color(name_color) | size(WIDTH, EQUAL, 30),
+            text(std::to_string(h->count())) | size(WIDTH, EQUAL, 8),
+            text(formatMs(h->percentileMs(50))) | size(WIDTH, EQUAL, 10),
+            text(formatMs(h->percentileMs(99))) | size(WIDTH, EQUAL, 10),
+            text(formatMs(h->maxMs())) | dim | size(WIDTH, EQUAL, 10),
+            text(h->totalBytes() ? formatBytes(h->totalBytes()) : "-") | dim | size(WIDTH, EQUAL, 8),
+        }));
+    }
+
+    return vbox({
+        text("STATS") | bold | center,
+        text(""),
+        hbox({text("  "), vbox(rows), text("  ")}),
+        text(""),
+        text("F12/Esc to close") | dim | center,
+    }) | border | clear_under | center;
+}
+
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <ftxui/component/component.hpp>
+#include <ftxui/dom/elements.hpp>
+#include <cstdio>
+#include <memory>
+#include <set>
+
+#include "../../api/slurmjobs.hpp"
+#include "../jobdetails.hpp"
+
+namespace ui {
+using namespace ftxui;
+
+inline std::string stepDuration(double seconds) {
+    long s = (long)(seconds + 0.5);
+    char buf[32];
+    if (s >= 86400) std::snprintf(buf, sizeof(buf), "%ld-%02ld:%02ld:%02ld", s / 86400, s / 3600 % 24, s / 60 % 60, s % 60);
+    else std::snprintf(buf, sizeof(buf), "%02ld:%02ld:%02ld", s / 3600, s / 60 % 60, s % 60);
+    return buf;
+}
+
+inline std::string stepSize(long long bytes) {
+    if (bytes <= 0) return "-";
+    const char* units = "KMGT";
+    double value = bytes / 1024.0;
+    int unit = 0;
+    while (value >= 1024 && unit < 3) {
+        value /= 1024;
+        ++unit;
+    }
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.1f%c", value, units[unit]);
+    return buf;
+}
+
+// The steps of a job as a tree under it, with time, CPU, memory and disk
+// use per step; the longest srun step is marked as the bottleneck. Enter
+// expands a step to its node list.
+inline Component stepsModal(const api::DetailedJob& job, std::function<void()> on_close) {
+    struct State {
+        std::vector<api::JobStep> steps;
+        std::set<size_t> expanded;
+        size_t selected = 0;
+    };
+
+    auto state = std::make_shared<State>();
+    state->steps = api::slurm::getJobSteps(job.id);
+
+    auto content = Renderer([=] {
+        const auto& steps = state->steps;
+
+        double longest = 0;
+        int bottleneck = -1;
+        for (size_t i = 0; i < steps.size(); ++i) {
+            longest = std::max(longest, steps[i].elapsed_seconds);
+            // batch and extern last as long as the job itself
+            if (steps[i].name == "batch" || steps[i].name == "extern") continue;
+            if (bottleneck < 0 || steps[i].elapsed_seconds > steps[bottleneck].elapsed_seconds) bottleneck = i;
+        }
+
+        constexpr int bar_width = 10;
+
+        std::vector<Element> rows;
+        rows.push_back(hbox({
+            text("STEP") | bold | size(WIDTH, EQUAL, 26),
+            text("STATE") | bold | size(WIDTH, EQUAL, 14),
+            text("ELAPSED") | bold | size(WIDTH, EQUAL, 24),
+            text("CPU TIME") | bold | size(WIDTH, EQUAL, 13),
+            text("CPU") | bold | size(WIDTH, EQUAL, 6),
+            text("MAXRSS") | bold | size(WIDTH, EQUAL, 9),
+            text("READ") | bold | size(WIDTH, EQUAL, 9),
+            text("WRITE") | bold | size(WIDTH, EQUAL, 9),
+        }));
+        rows.push_back(separator());
+
+        for (size_t i = 0; i < steps.size(); ++i) {
+            const auto& step = steps[i];
+            bool last = i + 1 == steps.size();
+            bool open = state->expanded.count(i) > 0;
+
+            std::string name = step.id.substr(step.id.find('.') + 1);
+            if (step.name != "batch" && step.name != "extern" && !step.name.empty()) name += " " + step.name;
+            if (name.size() > 20) name = name.substr(0, 19) + "…";
+            std::string label = std::string(last ? "└─" : "├─") + (open ? "▾ " : "▸ ") + name;
+
+            int filled = longest > 0 ? (int)(step.elapsed_seconds / longest * bar_width + 0.5) : 0;
+            std::string bar;
+            for (int k = 0; k < filled; ++k) bar += "■";
+
+            double allocated = step.elapsed_seconds * step.cpus;
+            std::string cpu = allocated > 0 ? std::to_string((int)(step.cpu_seconds / allocated * 100 + 0.5)) + "%" : "-";
+
+            Element row = hbox({
+                text(label) | size(WIDTH, EQUAL, 26),
+                text(step.state) | color(statusColor(step.state)) | size(WIDTH, EQUAL, 14),
+                text(stepDuration(step.elapsed_seconds) + " ") | size(WIDTH, EQUAL, 12),
+                text(bar) | color((int)i == bottleneck ? Color::Yellow : Color::Blue),
+                text(std::string(bar_width - filled, '.')) | dim,
+                text("  "),
+                text(stepDuration(step.cpu_seconds)) | size(WIDTH, EQUAL, 13),
+                text(cpu) | size(WIDTH, EQUAL, 6),
+                text(stepSize(step.max_rss_bytes)) | size(WIDTH, EQUAL, 9),
+                text(stepSize(step.disk_read_bytes)) | size(WIDTH, EQUAL, 9),
+                text(stepSize(step.disk_write_bytes)) | size(WIDTH, EQUAL, 9),
+                (int)i == bottleneck ? text("◀ longest") | color(Color::Yellow) : text(""),
+                step.live ? text(" live") | color(Color::Green) : text(""),
+            });
+            if (i == state->selected) row = row | inverted;
+            rows.push_back(row);
+
+            if (open) {
+                rows.push_back(hbox({
+                    text(last ? "     " : "│    "),
+                    text("nodes: ") | dim,
+                    text(step.node_list.empty() ? "-" : step.node_list),
+                    text("   CPUs: ") | dim,
+                    text(std::to_string(step.cpus)),
+                }));
+            }
+        }
+
+        if (steps.empty()) rows.push_back(text("No steps accounted for this job yet") | dim);
+
+        return vbox({
+            text("STEPS OF " + job.id + " (" + job.name + ")") | bold | center,
+            text(""),
+            hbox({text("  "), vbox(rows), text("  ")}),
+            text(""),
+            hbox({text("  "),
+                  text("CPU: TotalCPU / (Elapsed × CPUs)   READ/WRITE: average per task   live: from sstat") | dim,
+                  text("  ")}),
+            text(""),
+            text("↑↓: select   Enter: nodes   Any key: close") | dim | center,
+        }) | border;
+    });
+
+    return CatchEvent(content, [=](Event e) {
+        if (e == Event::ArrowDown) {
+            if (state->selected + 1 < state->steps.size()) ++state->selected;
+            return true;
+        }
+        if (e == Event::ArrowUp) {
+            if (state->selected > 0) --state->selected;
+            return true;
+        }
+        if (e == Event::Return || e == Event::ArrowRight || e == Event::ArrowLeft) {
+            if (!state->expanded.erase(state->selected) && e != Event::ArrowLeft) state->expanded.insert(state->selected);
+            return true;
+        }
+        if (e.is_character() || e == Event::Escape) {
+            on_close();
+            return true;
+        }
+        return false;
+    });
+}
+
+}
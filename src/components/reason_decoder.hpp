@@ -10,7 +10,7 @@ struct ReasonInfo {
     std::string suggestion;
 };
 
-inline ReasonInfo decodeReason(const std::string& reason) {
+inline const std::map<std::string, ReasonInfo>& reasonTable() {
     static const std::map<std::string, ReasonInfo> reasons = {
         {"Resources", {
             "Requested resources not available",
@@ -72,6 +72,10 @@ inline ReasonInfo decodeReason(const std::string& reason) {
             "Dependency cannot be satisfied",
             "Dependent job failed, cancel this job"
         }},
+        {"JobArrayTaskLimit", {
+            "Array task limit reached (%N throttle)",
+            "Wait for running tasks to finish"
+        }},
         {"BeginTime", {
             "Start time not reached",
             "Wait for time specified by --begin"
@@ -101,6 +105,15 @@ inline ReasonInfo decodeReason(const std::string& reason) {
             ""
         }},
     };
+    return reasons;
+}
+
+inline bool isKnownReason(const std::string& reason) {
+    return reasonTable().count(reason) > 0;
+}
+
+inline ReasonInfo decodeReason(const std::string& reason) {
+    const auto& reasons = reasonTable();
 
     auto it = reasons.find(reason);
     if (it != reasons.end()) {
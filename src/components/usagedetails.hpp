@@ -0,0 +1,77 @@
+#pragma once
+
+#include <ftxui/component/component.hpp>
+#include <ftxui/dom/elements.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "../api/slurmjobs.hpp"
+#include "../api/sampler.hpp"
+
+namespace ui {
+
+// One bar per value, only the last `columns` of them so the newest samples
+// are the ones that fit.
+inline std::string sparkline(const std::vector<float>& values, float max, size_t columns) {
+    static const char* bars[] = {"▁", "▂", "▃", "▄", "▅", "▆", "▇", "█"};
+
+    std::string line;
+    for (size_t i = values.size() - std::min(values.size(), columns); i < values.size(); ++i) {
+        float v = values[i];
+        int level = max > 0 ? (int)(v / max * 7.f + 0.5f) : 0;
+        line += bars[std::clamp(level, 0, 7)];
+    }
+    return line;
+}
+
+inline std::string formatFloat(float value, int precision = 1) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.*f", precision, value);
+    return buf;
+}
+
+// `width` is the columns the pane is given; the sparklines fill what is
+// left after their labels.
+inline ftxui::Element usagedetails(const api::DetailedJob& job, const api::JobUsage& usage, int width) {
+    using namespace ftxui;
+    constexpr int LABEL = 5;
+    size_t columns = (size_t)std::max(1, width - LABEL);
+
+    auto cpu = usage.busy_cores.values();
+    auto mem = usage.rss_gib.values();
+
+    if (cpu.empty()) {
+        return vbox({
+            text("Usage (sstat)") | bold,
+            text("Sampling...") | dim,
+        });
+    }
+
+    float mem_max = *std::max_element(mem.end() - std::min(mem.size(), columns), mem.end());
+    float cpu_now = cpu.back();
+    Color cpu_color = job.cpus > 0 && cpu_now < job.cpus * 0.25f ? Color::Red : Color::Green;
+
+    return vbox({
+        text("Usage (sstat)") | bold,
+        hbox({
+            text("CPU  ") ,
+            text(sparkline(cpu, (float)std::max(1, job.cpus), columns)) | color(cpu_color),
+        }),
+        hbox({
+            text("     "),
+            text(formatFloat(cpu_now) + " / " + std::to_string(job.cpus) + " cores busy") | dim,
+        }),
+        hbox({
+            text("RSS  "),
+            text(sparkline(mem, mem_max, columns)) | color(Color::BlueLight),
+        }),
+        hbox({
+            text("     "),
+            text(formatFloat(mem.back(), 2) + " GiB peak task") | dim,
+        }),
+    });
+}
+
+}
@@ -0,0 +1,219 @@
+// rsvd: per-login-node cache shared by every rsv instance. Polls squeue,
+// sinfo and scontrol once per interval and answers rsv clients from the
+// latest snapshot over a Unix socket (protocol in api/rsvd.hpp), so the
+// controller sees one set of RPCs per interval however many users run rsv.
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include <poll.h>
+#include <pwd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "../api/slurmjobs.hpp"
+#include "../api/rsvd.hpp"
+
+namespace {
+
+struct Snapshot {
+    std::string jobs;        // "<user> <JOBS_FORMAT fields>" per line
+    std::string partitions;
+    std::string nodes;
+    std::chrono::steady_clock::time_point taken;
+};
+
+std::atomic<bool> running{true};
+int server_fd = -1;
+
+void stop(int) {
+    running = false;
+    if (server_fd >= 0) shutdown(server_fd, SHUT_RDWR);
+}
+
+Snapshot poll() {
+    Snapshot s;
+    s.jobs = api::slurm::exec(std::string("squeue -a --noheader -o \"%u ") + api::slurm::JOBS_FORMAT + "\" 2>/dev/null");
+    s.partitions = api::slurm::exec(api::slurm::PARTITIONS_COMMAND);
+    s.nodes = api::slurm::exec(api::slurm::NODES_COMMAND);
+    s.taken = std::chrono::steady_clock::now();
+    return s;
+}
+
+// Keeps the lines owned by `user` and strips the leading user column.
+std::string jobsOf(const std::string& all, const std::string& user) {
+    std::string out;
+    std::istringstream iss(all);
+    for (std::string line; std::getline(iss, line); ) {
+        if (line.size() > user.size() && line.compare(0, user.size(), user) == 0 && line[user.size()] == ' ') {
+            out += line.substr(user.size() + 1) + "\n";
+        }
+    }
+    return out;
+}
+
+std::string peerUser(int fd) {
+    ucred cred{};
+    socklen_t len = sizeof(cred);
+    if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) != 0) return "";
+
+    // clients are served concurrently, so not getpwuid
+    passwd pw{};
+    passwd* found = nullptr;
+    char buffer[4096];
+    if (getpwuid_r(cred.uid, &pw, buffer, sizeof(buffer), &found) != 0 || !found) return "";
+    return found->pw_name;
+}
+
+// Reads the request line within one deadline for the whole line, however
+// slowly the client sends it.
+std::string readRequest(int fd, std::chrono::milliseconds budget) {
+    auto deadline = std::chrono::steady_clock::now() + budget;
+    std::string request;
+    char buffer[64];
+
+    while (request.size() < sizeof(buffer)) {
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        pollfd pfd{fd, POLLIN, 0};
+        if (left.count() <= 0 || ::poll(&pfd, 1, (int)left.count()) <= 0) return "";
+
+        ssize_t n = read(fd, buffer, sizeof(buffer) - request.size());
+        if (n <= 0) return "";
+        request.append(buffer, n);
+
+        size_t eol = request.find('\n');
+        if (eol != std::string::npos) return request.substr(0, eol);
+    }
+    return "";
+}
+
+void serve(int fd, const std::shared_ptr<const Snapshot>& snapshot) {
+    timeval timeout{1, 0};
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    std::string request = readRequest(fd, std::chrono::seconds(1));
+
+    std::string payload;
+    bool ok = snapshot != nullptr;
+    if (ok && request == "jobs") {
+        std::string user = peerUser(fd);
+        ok = !user.empty();
+        payload = jobsOf(snapshot->jobs, user);
+    } else if (ok && request == "partitions") {
+        payload = snapshot->partitions;
+    } else if (ok && request == "nodes") {
+        payload = snapshot->nodes;
+    } else {
+        ok = false;
+    }
+
+    std::string response;
+    if (ok) {
+        auto age = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::steady_clock::now() - snapshot->taken).count();
+        response = "OK " + std::to_string(age) + "\n" + payload;
+    } else {
+        response = "ERR " + request + "\n";
+    }
+
+    size_t sent = 0;
+    while (sent < response.size()) {
+        ssize_t n = write(fd, response.data() + sent, response.size() - sent);
+        if (n <= 0) break;
+        sent += n;
+    }
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::string path = api::rsvd::socketPath();
+    int interval = 30;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--socket" && i + 1 < argc) {
+            path = argv[++i];
+        } else if (arg == "--interval" && i + 1 < argc) {
+            interval = std::max(1, std::atoi(argv[++i]));
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--socket <path>] [--interval <seconds>]\n";
+            return 1;
+        }
+    }
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "rsvd: socket path too long: " << path << "\n";
+        return 1;
+    }
+    std::strcpy(addr.sun_path, path.c_str());
+
+    // clients only trust a socket whose directory nobody else can write to
+    size_t slash = path.find_last_of('/');
+    if (slash != std::string::npos && slash > 0) mkdir(path.substr(0, slash).c_str(), 0755);
+
+    server_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    unlink(path.c_str());
+    if (server_fd < 0 || bind(server_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        listen(server_fd, 64) != 0) {
+        std::cerr << "rsvd: cannot listen on " << path << ": " << std::strerror(errno) << "\n";
+        return 1;
+    }
+    // every user on the login node may connect; jobs are filtered by peer uid
+    // (the directory, not the socket, keeps others from replacing it)
+    chmod(path.c_str(), 0666);
+
+    std::signal(SIGINT, stop);
+    std::signal(SIGTERM, stop);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    std::mutex m;
+    std::condition_variable cv;
+    std::shared_ptr<const Snapshot> snapshot;
+
+    std::thread poller([&] {
+        while (running) {
+            auto next = std::make_shared<const Snapshot>(poll());
+            std::atomic_store(&snapshot, next);
+
+            std::unique_lock<std::mutex> lock(m);
+            cv.wait_for(lock, std::chrono::seconds(interval), [] { return !running.load(); });
+        }
+    });
+
+    std::cerr << "rsvd: serving " << path << " every " << interval << "s\n";
+
+    while (running) {
+        int client = accept4(server_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        // one thread per client, so a slow one holds up nobody else
+        std::thread([client, s = std::atomic_load(&snapshot)] {
+            serve(client, s);
+            close(client);
+        }).detach();
+    }
+
+    running = false;
+    cv.notify_all();
+    poller.join();
+
+    close(server_fd);
+    unlink(path.c_str());
+    return 0;
+}
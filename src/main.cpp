@@ -4,86 +4,241 @@
 #include <chrono>
 #include <thread>
 #include <atomic>
+#include <optional>
+#include <set>
 
 #include "api/slurmjobs.hpp"
+#include "api/sampler.hpp"
+#include "api/stats.hpp"
+#include "api/exporter.hpp"
+#include "api/replay.hpp"
+#include "api/snapshot.hpp"
+#include "api/efficiency.hpp"
+#include "api/queuewait.hpp"
 
 #include "components/nodedetails.hpp"
 #include "components/apudetails.hpp"
 #include "components/jobdetails.hpp"
+#include "components/usagedetails.hpp"
 #include "components/footer.hpp"
 #include "components/title.hpp"
+#include "components/dashboard.hpp"
 
 #include "components/prompts/partitions.hpp"
 #include "components/prompts/cancel.hpp"
+#include "components/prompts/mark.hpp"
 #include "components/prompts/help.hpp"
 #include "components/prompts/logs.hpp"
+#include "components/prompts/steps.hpp"
+#include "components/prompts/heatmap.hpp"
+#include "components/prompts/efficiency.hpp"
+#include "components/prompts/stats.hpp"
 
 using namespace ftxui;
 
-int main() {
-    auto jobs = std::make_shared<std::vector<api::Job>>(api::slurm::getUserJobs());
-    if (jobs->empty()) {
+int main(int argc, char** argv) {
+    std::string stats_out;
+    int headless_frames = 0;
+    std::string export_target;
+    int export_interval = 30;
+    std::string record_dir;
+    std::string replay_dir;
+    double replay_speed = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--stats-out" && i + 1 < argc) {
+            stats_out = argv[++i];
+        } else if (arg == "--headless" && i + 1 < argc) {
+            headless_frames = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--export" && i + 1 < argc) {
+            export_target = argv[++i];
+        } else if (arg == "--export-interval" && i + 1 < argc) {
+            export_interval = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--record" && i + 1 < argc) {
+            record_dir = argv[++i];
+        } else if (arg == "--replay" && i + 1 < argc) {
+            replay_dir = argv[++i];
+        } else if (arg == "--replay-speed" && i + 1 < argc) {
+            replay_speed = std::max(0.0, std::atof(argv[++i]));
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--stats-out <file>] [--headless <frames>]"
+                      << " [--export <file|unix:path> [--export-interval <seconds>]]"
+                      << " [--record <dir> | --replay <dir> [--replay-speed <x>]]\n";
+            return 1;
+        }
+    }
+
+    if (!record_dir.empty() && !api::replay::startRecording(record_dir)) {
+        std::cerr << "Cannot record to " << record_dir << "\n";
+        return 1;
+    }
+    if (!replay_dir.empty() && !api::replay::startReplay(replay_dir, replay_speed)) {
+        std::cerr << "Cannot replay " << api::replay::logPath(replay_dir) << "\n";
+        return 1;
+    }
+
+    if (!export_target.empty()) {
+        return api::exporter::run(export_target, export_interval);
+    }
+
+    // Fetched state is published as immutable versions; `view` is the one on
+    // screen, which `entries` and `selected` index. Only the UI thread moves
+    // `view`, so renderers never see the list change under them.
+    api::SnapshotStore store;
+    auto view = api::refresh(store);
+    if (view->jobs->empty()) {
         std::cout << "No jobs found for current user\n";
         return 0;
     }
 
+    // ids of the jobs marked for a bulk cancel
+    std::set<std::string> marked;
+
     auto entries = std::make_shared<std::vector<std::string>>();
-    for (const auto& job : *jobs)
-        entries->push_back(job.name + " (" + job.id + ")");
+    auto rebuild_entries = [&] {
+        entries->clear();
+        for (const auto& job : *view->jobs) {
+            std::string entry = marked.count(job.id) ? "●" : " ";
+            bool pinned = std::find(view->pinned.begin(), view->pinned.end(), job.id) != view->pinned.end();
+            entry += pinned ? "◆ " : "  ";
+
+            if (job.isArray()) {
+                entry += (view->expanded.count(job.id) ? "▾ " : "▸ ") + job.name + " " + job.id + "_[" + job.tasks + "]";
+                for (const auto& [state, count] : job.task_states)
+                    entry += " " + ui::shortState(state) + std::to_string(count);
+            } else if (!job.array_id.empty()) {
+                entry += "    " + job.id + " " + ui::shortState(job.state);
+            } else {
+                entry += job.name + " (" + job.id + ")";
+            }
+
+            entries->push_back(entry);
+        }
+    };
+    rebuild_entries();
 
     int selected = 0;
     
     bool show_help = false;
     bool show_logs = false;
+    bool show_steps = false;
     bool show_partitions = false;
     bool show_cancel_confirm = false;
+    bool show_mark = false;
+    bool show_heatmap = false;
+    bool show_efficiency = false;
+    bool show_stats = false;
+    // the right pane shows the pinned jobs instead of the selected one
+    bool show_dashboard = false;
+    // node of the focused job whose other jobs are listed, -1 for none
+    int selected_node = -1;
 
     auto log_show_stderr = std::make_shared<bool>(false);
-    auto log_scroll_y = std::make_shared<float>(0.f);
+
+    auto partitions = std::make_shared<std::vector<api::PartitionInfo>>();
+    auto cluster_nodes = std::make_shared<api::ClusterNodes>();
+    auto heatmap_by_apu = std::make_shared<bool>(false);
+    auto heatmap_scroll = std::make_shared<float>(0.f);
+    auto efficiency = std::make_shared<api::EfficiencyTable>();
+    auto efficiency_by = std::make_shared<api::EfficiencyBy>(api::EfficiencyBy::Name);
+
+    // the efficiency history streams in from its own thread, a day at a time
+    std::thread efficiency_thread;
+    std::atomic<bool> efficiency_loading{false};
+    // queue waits are updated from sacct on their own thread as well
+    auto queue_waits = std::make_shared<api::QueueWaits>();
+    std::optional<api::WaitShape> wait_shape;
+    std::thread queuewait_thread;
+    std::atomic<bool> queuewait_loading{false};
+    std::atomic<bool> quitting{false};
 
     std::string status_message;
 
     std::string cancel_job_id;
     std::string cancel_job_name;
+    std::vector<api::Job> cancel_jobs;
 
-    auto last_refresh = std::chrono::steady_clock::now();
-    constexpr int AUTO_REFRESH_SECONDS = 30;
+    std::string mark_pattern;
 
-    auto current_job = std::make_shared<api::DetailedJob>(api::slurm::getJobDetails((*jobs)[selected].id));
+    constexpr int AUTO_REFRESH_SECONDS = 30;
 
     ScreenInteractive screen = ScreenInteractive::Fullscreen();
 
-    auto refresh_jobs = [&]() {
-        *jobs = api::slurm::getUserJobs();
-        entries->clear();
-        
-        for (const auto& job : *jobs)
-            entries->push_back(job.name + " (" + job.id + ")");
+    constexpr int HEADLESS_WIDTH = 200;
+    constexpr int HEADLESS_HEIGHT = 60;
+    auto screen_width = [&] {
+        return headless_frames > 0 ? HEADLESS_WIDTH : screen.dimx();
+    };
 
-        if (jobs->empty()) {
-            status_message = "No jobs";
-            return;
+    api::UsageSampler sampler([&] { screen.Post(Event::Custom); });
+
+    auto watch_current = [&] {
+        sampler.watch(view->details->status == "RUNNING" ? view->details->id : "");
+    };
+    watch_current();
+
+    // Puts `next` on screen: drops marks of jobs no longer listed and keeps
+    // the selection on the focused row when rows moved.
+    auto adopt = [&](std::shared_ptr<const api::Snapshot> next) {
+        bool rows_changed = next->jobs != view->jobs;
+        view = std::move(next);
+        const auto& jobs = *view->jobs;
+
+        if (rows_changed) {
+            std::set<std::string> listed;
+            for (const auto& job : jobs) listed.insert(job.id);
+            for (auto it = marked.begin(); it != marked.end(); ) {
+                if (listed.count(*it)) ++it;
+                else it = marked.erase(it);
+            }
         }
 
-        if (selected >= (int)jobs->size()) {
-            selected = jobs->size() - 1;
+        if (selected >= (int)jobs.size() || jobs[selected].detail_id != view->focus) {
+            auto it = std::find_if(jobs.begin(), jobs.end(), [&](const api::Job& job) {
+                return job.detail_id == view->focus;
+            });
+            selected = it == jobs.end() ? 0 : it - jobs.begin();
         }
-        *current_job = api::slurm::getJobDetails((*jobs)[selected].id);
-        
-        last_refresh = std::chrono::steady_clock::now();
-        status_message = "Refreshed!";
+
+        rebuild_entries();
+        watch_current();
+    };
+
+    auto refresh_jobs = [&]() {
+        adopt(api::refresh(store));
+        status_message = view->jobs->empty() ? "No jobs" : "Refreshed!";
     };
 
     Component job_info = Renderer([&] {
         return hbox({
-            ui::jobdetails(*current_job)->Render(),
+            ui::jobdetails(*view->details)->Render(),
             text("  "),
-            ui::apudetails(*current_job)->Render()
+            ui::apudetails(*view->details)->Render()
         });
     });
 
     Component job_nodes_content = Renderer([&] {
-        return ui::nodedetails(*current_job, screen.dimx())->Render();
+        constexpr int usage_width = 36;
+
+        const api::DetailedJob& job = *view->details;
+        auto tenancy = view->cotenancy ? view->tenancy : nullptr;
+
+        Element tenants = text("");
+        if (tenancy && selected_node >= 0 && selected_node < (int)tenancy->size() &&
+            selected_node < (int)job.node_allocations.size()) {
+            tenants = ui::nodeTenants((*tenancy)[selected_node], job.node_allocations[selected_node].allocated_cores.size());
+        }
+
+        api::JobUsage usage;
+        if (job.status == "RUNNING" && sampler.usage(job.id, usage)) {
+            return hbox({
+                vbox({tenants, ui::nodedetails(job, screen_width() - usage_width, tenancy, selected_node, usage.node_rss_bytes)->Render()}) | flex,
+                ui::usagedetails(job, usage, usage_width) | size(WIDTH, EQUAL, usage_width),
+            });
+        }
+
+        return vbox({tenants, ui::nodedetails(job, screen_width(), tenancy, selected_node)->Render()});
     });
 
     float scroll_y = 0.f;
@@ -123,14 +278,64 @@ int main() {
         job_nodes_scrollable | flex,
     });
 
-    MenuOption menu_opt;
-    menu_opt.on_change = [&] {
-        if (!jobs->empty() && selected < (int)jobs->size()) {
-            *current_job = api::slurm::getJobDetails((*jobs)[selected].id);
+    auto select_job = [&] {
+        if (!view->jobs->empty() && selected < (int)view->jobs->size()) {
+            std::string focus = (*view->jobs)[selected].detail_id;
+            auto details = std::make_shared<const api::DetailedJob>(api::slurm::getJobDetails(focus));
+            auto tenancy = std::make_shared<const std::vector<api::NodeTenancy>>();
+            if (view->cotenancy) tenancy = std::make_shared<const std::vector<api::NodeTenancy>>(api::slurm::getNodeTenancy(*details));
+
+            adopt(store.update([&](api::Snapshot& next) {
+                next.focus = focus;
+                next.details = details;
+                next.tenancy = tenancy;
+            }));
             scroll_y = 0.f;
+            selected_node = view->cotenancy && !details->node_allocations.empty() ? 0 : -1;
         }
     };
 
+    auto toggle_array = [&] {
+        if (view->jobs->empty() || !(*view->jobs)[selected].isArray()) return;
+
+        const std::string id = (*view->jobs)[selected].id;
+        adopt(store.update([&](api::Snapshot& next) {
+            // the latest version may list rows the screen does not show yet
+            std::vector<api::Job> jobs = *next.jobs;
+            auto row = std::find_if(jobs.begin(), jobs.end(), [&](const api::Job& job) {
+                return job.id == id && job.isArray();
+            });
+            if (row == jobs.end()) return;
+
+            if (next.expanded.erase(id)) {
+                auto last = std::find_if(row + 1, jobs.end(), [&](const api::Job& job) {
+                    return job.array_id != id || job.isArray();
+                });
+                jobs.erase(row + 1, last);
+            } else {
+                next.expanded.insert(id);
+                api::expandArray(jobs, row - jobs.begin());
+            }
+            next.jobs = std::make_shared<const std::vector<api::Job>>(std::move(jobs));
+        }));
+    };
+
+    // Turns the listing of the other jobs on the focused job's nodes on or off.
+    auto set_cotenancy = [&](bool on) {
+        auto tenancy = std::make_shared<const std::vector<api::NodeTenancy>>();
+        if (on) tenancy = std::make_shared<const std::vector<api::NodeTenancy>>(api::slurm::getNodeTenancy(*view->details));
+
+        adopt(store.update([&](api::Snapshot& next) {
+            next.cotenancy = on;
+            next.tenancy = tenancy;
+        }));
+        selected_node = on && !view->details->node_allocations.empty() ? 0 : -1;
+    };
+
+    MenuOption menu_opt;
+    menu_opt.on_change = select_job;
+    menu_opt.on_enter = toggle_array;
+
     Component sidebar =
         Menu(entries.get(), &selected, menu_opt)
         | size(WIDTH, EQUAL, 30);
@@ -140,18 +345,37 @@ int main() {
         job_nodes | flex,
     });
 
+    Component right_pane = Renderer(interface_job, [&] {
+        if (show_dashboard) return ui::dashboard(*view->tiles, screen_width() - 36) | yframe | flex;
+        return interface_job->Render();
+    });
+
     Component interface_jobs = Container::Horizontal({
         sidebar,
         Renderer([] { return hbox({text("  "), separator(), text("  ")}); }),
-        interface_job | flex,
+        right_pane | flex,
     });
 
     Component footer = Renderer([&] { 
         auto now = std::chrono::steady_clock::now();
-        auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - last_refresh).count();
+        auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - view->taken).count();
         int next_refresh = AUTO_REFRESH_SECONDS - elapsed;
         
+        // a query class the controller stopped answering is served from its
+        // last good output
+        std::string stale_text;
+        auto stale = api::slurm::staleData();
+        if (!stale.key.empty()) {
+            char since[16] = "never";
+            std::tm tm{};
+            if (stale.since && localtime_r(&stale.since, &tm)) std::strftime(since, sizeof(since), "%H:%M:%S", &tm);
+            stale_text = stale.key.substr(5) + " stale since " + since + "  ";
+        }
+
         Element footer_status = hbox({
+            text(stale_text) | bold | color(Color::Red),
+            text(marked.empty() ? "" : std::to_string(marked.size()) + " marked  ") | bold | color(Color::Yellow),
+            text(status_message) | dim,
             text(" Auto-refresh: " + std::to_string(next_refresh) + "s" ) | dim,
         });
 
@@ -170,7 +394,7 @@ int main() {
     Component help = ui::helpModal([&] { show_help = false; });
 
     Component partition_view = Renderer([&] {
-        return ui::paritionsModal()->Render();
+        return ui::paritionsModal(partitions, queue_waits, wait_shape ? &*wait_shape : nullptr, queuewait_loading)->Render();
     });
 
     partition_view = CatchEvent(partition_view, [&](Event e) {
@@ -181,15 +405,37 @@ int main() {
         return false;
     });
 
-    auto log_component = std::make_shared<Component>(
-        ui::logModal(*current_job, log_show_stderr, log_scroll_y, [&] { show_logs = false; })
+    auto log_component = std::make_shared<Component>();
+    auto steps_component = std::make_shared<Component>();
+
+    auto heatmap_component = std::make_shared<Component>(
+        ui::heatmapModal(cluster_nodes, heatmap_by_apu, heatmap_scroll, screen_width())
     );
 
+    Component efficiency_view = Renderer([&] {
+        return ui::efficiencyModal(efficiency, efficiency_by, screen_width())->Render();
+    });
+
+    Component mark_prompt = ui::markModal(&mark_pattern);
+
     Component interface = Container::Tab({main_content, help, partition_view}, nullptr);
 
+    // only the element tree: FTXUI lays out and draws it after this returns,
+    // out of reach (headless:frame times a whole off-screen frame)
+    api::Histogram& build_hist = api::stats::get("frame:build");
+
     interface = Renderer(interface, [&] {
+        api::stats::Scope build_scope(build_hist);
+
         Element base = main_content->Render();
 
+        if (show_stats) {
+            return dbox({
+                base,
+                ui::statsModal(),
+            });
+        }
+
         if (show_help) {
             return dbox({
                 base,
@@ -211,14 +457,55 @@ int main() {
             });
         }
 
+        if (show_steps) {
+            return dbox({
+                base,
+                (*steps_component)->Render() | clear_under | center,
+            });
+        }
+
+        if (show_heatmap) {
+            return dbox({
+                base,
+                (*heatmap_component)->Render() | clear_under | center,
+            });
+        }
+
+        if (show_efficiency) {
+            return dbox({
+                base,
+                efficiency_view->Render(),
+            });
+        }
+
+        if (show_mark) {
+            return dbox({
+                base,
+                mark_prompt->Render() | clear_under | center,
+            });
+        }
+
         if (show_cancel_confirm) {
-            return ui::cancelModal(base, *current_job);
+            if (!cancel_jobs.empty()) return ui::cancelManyModal(base, cancel_jobs);
+            return ui::cancelModal(base, *view->details);
         }
 
         return base;
     });
 
     interface = CatchEvent(interface, [&](Event e) {
+        if (e == Event::F12) {
+            show_stats = !show_stats;
+            return true;
+        }
+        if (show_stats) {
+            if (e == Event::Escape) {
+                show_stats = false;
+                return true;
+            }
+            return false;
+        }
+
         if (show_help) {
             if (e.is_character() || e == Event::Escape || e == Event::Return) {
                 show_help = false;
@@ -238,13 +525,87 @@ int main() {
             return (*log_component)->OnEvent(e);
         }
 
-    
+        if (show_steps) {
+            return (*steps_component)->OnEvent(e);
+        }
+
+        if (show_heatmap) {
+            if (e == Event::Tab || e == Event::TabReverse) {
+                *heatmap_by_apu = !*heatmap_by_apu;
+                *heatmap_scroll = 0.f;
+                return true;
+            }
+
+            float step = 0.f;
+            if (e == Event::ArrowDown) step = 0.05f;
+            else if (e == Event::ArrowUp) step = -0.05f;
+            else if (e == Event::PageDown) step = 0.25f;
+            else if (e == Event::PageUp) step = -0.25f;
+            else if (e == Event::Home) step = -1.f;
+            else if (e == Event::End) step = 1.f;
+            else if (e.is_mouse() && e.mouse().button == Mouse::WheelDown) step = 0.05f;
+            else if (e.is_mouse() && e.mouse().button == Mouse::WheelUp) step = -0.05f;
+            if (step != 0.f) {
+                *heatmap_scroll = std::clamp(*heatmap_scroll + step, 0.f, 1.f);
+                return true;
+            }
+
+            if (e.is_character() || e == Event::Escape || e == Event::Return) {
+                show_heatmap = false;
+                return true;
+            }
+            return false;
+        }
+
+        if (show_efficiency) {
+            if (e == Event::Tab || e == Event::TabReverse) {
+                int step = e == Event::Tab ? 1 : 2;
+                *efficiency_by = api::EfficiencyBy(((int)*efficiency_by + step) % 3);
+                return true;
+            }
+            if (e.is_character() || e == Event::Escape || e == Event::Return) {
+                show_efficiency = false;
+                return true;
+            }
+            return false;
+        }
+
+        if (show_mark) {
+            if (e == Event::Escape) {
+                show_mark = false;
+                return true;
+            }
+            if (e == Event::Return) {
+                for (const auto& job : *view->jobs) {
+                    if (ui::markMatches(job, mark_pattern)) marked.insert(job.id);
+                }
+                rebuild_entries();
+                show_mark = false;
+                return true;
+            }
+            return mark_prompt->OnEvent(e);
+        }
+
         if (show_cancel_confirm) {
             if (e == Event::Character('y') || e == Event::Character('Y')) {
 
-                if (api::slurm::cancelJob(cancel_job_id)) {
-                    status_message = "Job " + cancel_job_id + " cancelled";
+                if (!cancel_jobs.empty()) {
+                    std::vector<std::string> ids;
+                    for (const auto& job : cancel_jobs) ids.push_back(job.id);
+
+                    api::CancelResult result = api::slurm::cancelJobs(ids);
+                    marked.clear();
+                    refresh_jobs();
+
+                    status_message = std::to_string(result.cancelled.size()) + "/" +
+                                     std::to_string(ids.size()) + " jobs cancelled";
+                    if (!result.failed.empty()) {
+                        status_message += ", " + std::to_string(result.failed.size()) + " failed (" +
+                                          result.failed.front().first + ": " + result.failed.front().second + ")";
+                    }
+                } else if (api::slurm::cancelJob(cancel_job_id)) {
                     refresh_jobs();
+                    status_message = "Job " + cancel_job_id + " cancelled";
                 } else {
                     status_message = "Cancel failed";
                 }
@@ -280,24 +641,159 @@ int main() {
 
         if (e == Event::Character('c') || e == Event::Character('C') ||
             e == Event::Delete) {
-            if (!jobs->empty()) {
-                cancel_job_id = (*jobs)[selected].id;
-                cancel_job_name = (*jobs)[selected].name;
+            const auto& jobs = *view->jobs;
+            cancel_jobs.clear();
+            for (const auto& job : jobs) {
+                if (marked.count(job.id)) cancel_jobs.push_back(job);
+            }
+            // a whole array is confirmed like a bulk cancel
+            if (cancel_jobs.empty() && !jobs.empty() && jobs[selected].isArray()) {
+                cancel_jobs.push_back(jobs[selected]);
+            }
+
+            if (!jobs.empty()) {
+                cancel_job_id = jobs[selected].id;
+                cancel_job_name = jobs[selected].name;
                 show_cancel_confirm = true;
             }
             return true;
         }
 
+        if (e == Event::Character(' ')) {
+            if (!view->jobs->empty()) {
+                const std::string& id = (*view->jobs)[selected].id;
+                if (!marked.erase(id)) marked.insert(id);
+                rebuild_entries();
+            }
+            return true;
+        }
+
+        if (e == Event::Character('m') || e == Event::Character('M')) {
+            mark_pattern.clear();
+            show_mark = true;
+            return true;
+        }
+
+        if (e == Event::Character('x') || e == Event::Character('X')) {
+            marked.clear();
+            rebuild_entries();
+            return true;
+        }
+
         if (e == Event::Character('p') || e == Event::Character('P')) {
+            *partitions = api::slurm::getPartitions();
             show_partitions = true;
+
+            wait_shape.reset();
+            if (!view->details->id.empty()) {
+                const api::DetailedJob& job = *view->details;
+                wait_shape = api::WaitShape{std::max(1, job.nodes), job.gpus, api::slurm::parseDuration(job.maxTime)};
+            }
+
+            if (queuewait_loading) return true;
+            if (queuewait_thread.joinable()) queuewait_thread.join();
+            *queue_waits = api::queuewait::load();
+            queuewait_loading = true;
+            queuewait_thread = std::thread([&] {
+                auto waits = api::queuewait::update([&] { return !quitting.load(); });
+                screen.Post([&, waits] { *queue_waits = waits; });
+                screen.Post(Event::Custom);
+                queuewait_loading = false;
+            });
+            return true;
+        }
+
+        if (e == Event::Character('n') || e == Event::Character('N')) {
+            *cluster_nodes = api::slurm::getClusterNodes();
+            *heatmap_scroll = 0.f;
+            *heatmap_component = ui::heatmapModal(cluster_nodes, heatmap_by_apu, heatmap_scroll, screen_width());
+            show_heatmap = true;
+            return true;
+        }
+
+        if (e == Event::Character('e') || e == Event::Character('E')) {
+            show_efficiency = true;
+            if (efficiency_loading) return true;
+
+            if (efficiency_thread.joinable()) efficiency_thread.join();
+            *efficiency = api::EfficiencyTable();
+            efficiency_loading = true;
+            efficiency_thread = std::thread([&] {
+                api::slurm::getJobHistory("", 30, [&](const std::vector<api::JobHistory>& jobs, int done, int total) {
+                    screen.Post([&, jobs, done, total] {
+                        api::efficiency::append(*efficiency, jobs);
+                        efficiency->windows_done = done;
+                        efficiency->windows = total;
+                    });
+                    screen.Post(Event::Custom);
+                    return !quitting;
+                });
+                efficiency_loading = false;
+            });
+            return true;
+        }
+
+        if (e == Event::Character('t') || e == Event::Character('T')) {
+            if (view->jobs->empty()) return true;
+            const api::Job& job = (*view->jobs)[selected];
+            if (job.isArray()) {
+                status_message = "Expand the array to pin one of its tasks";
+                return true;
+            }
+
+            // tiles of every pinned job come from one batched fetch
+            const std::string id = job.id;
+            std::vector<std::string> pinned = view->pinned;
+            auto it = std::find(pinned.begin(), pinned.end(), id);
+            if (it != pinned.end()) pinned.erase(it);
+            else pinned.push_back(id);
+            auto tiles = std::make_shared<const std::vector<api::JobTile>>(api::slurm::getJobTiles(pinned));
+
+            adopt(store.update([&](api::Snapshot& next) {
+                next.pinned = pinned;
+                next.tiles = tiles;
+            }));
+            status_message = std::to_string(pinned.size()) + " pinned";
+            return true;
+        }
+
+        if (e == Event::Character('o') || e == Event::Character('O')) {
+            set_cotenancy(!view->cotenancy);
+            return true;
+        }
+
+        if (e == Event::Character('[') || e == Event::Character(']')) {
+            // the first press shows the first node
+            if (!view->cotenancy) {
+                set_cotenancy(true);
+                scroll_y = 0.f;
+                return true;
+            }
+
+            int count = view->details->node_allocations.size();
+            if (count == 0) return true;
+            selected_node = (selected_node + (e == Event::Character(']') ? 1 : count - 1)) % count;
+            scroll_y = count > 1 ? (float)selected_node / (count - 1) : 0.f;
+            return true;
+        }
+
+        if (e == Event::Character('d') || e == Event::Character('D')) {
+            show_dashboard = !show_dashboard;
+            return true;
+        }
+
+        if (e == Event::Character('s') || e == Event::Character('S')) {
+            if (!view->jobs->empty() && !view->details->id.empty()) {
+                *steps_component = ui::stepsModal(*view->details, [&] { show_steps = false; });
+                show_steps = true;
+            }
             return true;
         }
 
         if (e == Event::Character('l') || e == Event::Character('L')) {
-            if (!jobs->empty()) {
+            if (!view->jobs->empty()) {
                 *log_show_stderr = false;
-                *log_scroll_y = 0.f;
-                *log_component = ui::logModal(*current_job, log_show_stderr, log_scroll_y, [&] { show_logs = false; });
+                *log_component = ui::logModal(*view->details, log_show_stderr, [&] { show_logs = false; });
                 show_logs = true;
             }
             return true;
@@ -306,6 +802,30 @@ int main() {
         return false;
     });
 
+    // Drives the UI without a terminal: walks the job list, refreshing every
+    // few frames like the auto-refresh would, and renders off-screen.
+    if (headless_frames > 0) {
+        api::Histogram& headless_hist = api::stats::get("headless:frame");
+
+        for (int i = 0; i < headless_frames && !view->jobs->empty(); ++i) {
+            if (i % 10 == 9) refresh_jobs();
+            if (view->jobs->empty()) break;
+
+            selected = i % view->jobs->size();
+            select_job();
+
+            api::stats::Scope frame_scope(headless_hist);
+            auto off_screen = Screen::Create(Dimension::Fixed(HEADLESS_WIDTH), Dimension::Fixed(HEADLESS_HEIGHT));
+            Render(off_screen, interface->Render());
+        }
+
+        if (!stats_out.empty() && !api::stats::dump(stats_out)) {
+            std::cerr << "Cannot write stats to " << stats_out << "\n";
+            return 1;
+        }
+        return 0;
+    }
+
     std::atomic<bool> running{true};
     
     std::mutex m;
@@ -323,7 +843,13 @@ int main() {
             if (!running)
                 break;
 
-            screen.Post([&] { refresh_jobs(); });
+            // fetched here, off the event loop; the UI only swaps it in
+            // (the latest version, the UI may have published past this one)
+            api::refresh(store);
+            screen.Post([&] {
+                adopt(store.load());
+                status_message = view->jobs->empty() ? "No jobs" : "Refreshed!";
+            });
             screen.Post(Event::Custom);
         }
     });
@@ -331,8 +857,18 @@ int main() {
     screen.Loop(interface);
 
     running = false;
+    quitting = true;
+    // the history threads may be waiting on sacct for minutes
+    api::slurm::abortCommands();
     cv.notify_all();
     refresh_thread.join();
+    if (efficiency_thread.joinable()) efficiency_thread.join();
+    if (queuewait_thread.joinable()) queuewait_thread.join();
+
+    if (!stats_out.empty() && !api::stats::dump(stats_out)) {
+        std::cerr << "Cannot write stats to " << stats_out << "\n";
+        return 1;
+    }
 
     return 0;
 }
@@ -0,0 +1,882 @@
+// Synthetic stand-in for the Slurm client commands rsv calls. One binary,
+// dispatched on argv[0] (squeue, scontrol, sinfo, sacct, sstat, scancel),
+// generating a deterministic cluster from environment variables:
+//
+//   FAKESLURM_NODES        nodes in the cluster              (default 64)
+//   FAKESLURM_JOBS         jobs owned by $USER               (default 20)
+//   FAKESLURM_OTHER_JOBS   jobs owned by other users         (default 2 * jobs)
+//   FAKESLURM_CORES        cores per node                    (default 128)
+//   FAKESLURM_GPUS         GPUs per node                     (default 4)
+//   FAKESLURM_ARRAY_TASKS  tasks of one extra $USER array    (default 0)
+//   FAKESLURM_HISTORY      finished jobs reported by sacct   (default 10 * jobs)
+//   FAKESLURM_LATENCY_MS   sleep before answering            (default 0)
+//   FAKESLURM_SEED         generator seed                    (default 1)
+//   FAKESLURM_COUNT_FILE   if set, one line per invocation is appended
+//
+// Cancellations are not persisted: every call regenerates the same cluster.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+int envInt(const char* name, int fallback) {
+    const char* v = std::getenv(name);
+    if (!v || !*v) return fallback;
+    try { return std::stoi(v); } catch (...) { return fallback; }
+}
+
+struct Config {
+    int nodes = envInt("FAKESLURM_NODES", 64);
+    int jobs = envInt("FAKESLURM_JOBS", 20);
+    int other_jobs = envInt("FAKESLURM_OTHER_JOBS", 2 * envInt("FAKESLURM_JOBS", 20));
+    int cores = std::max(1, envInt("FAKESLURM_CORES", 128));
+    int gpus = envInt("FAKESLURM_GPUS", 4);
+    int array_tasks = envInt("FAKESLURM_ARRAY_TASKS", 0);
+    int history = envInt("FAKESLURM_HISTORY", 10 * envInt("FAKESLURM_JOBS", 20));
+    int latency_ms = envInt("FAKESLURM_LATENCY_MS", 0);
+    unsigned seed = (unsigned)envInt("FAKESLURM_SEED", 1);
+    std::string user = std::getenv("USER") ? std::getenv("USER") : "unknown";
+};
+
+// splitmix64, so a given seed produces the same cluster on every platform
+struct Rng {
+    uint64_t state;
+    explicit Rng(uint64_t seed) : state(seed) {}
+    uint64_t next() {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+    int range(int lo, int hi) { return lo + (int)(next() % (uint64_t)(hi - lo + 1)); }
+};
+
+std::string nodeName(int i) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "fake%04d", i + 1);
+    return buf;
+}
+
+int nodeIndex(const std::string& name) {
+    if (name.size() < 5 || name.compare(0, 4, "fake") != 0) return -1;
+    try { return std::stoi(name.substr(4)) - 1; } catch (...) { return -1; }
+}
+
+// "fake[0001-0003,0007]" -> fake0001 fake0002 fake0003 fake0007
+std::vector<std::string> expandHostlist(const std::string& list) {
+    std::vector<std::string> out;
+    size_t pos = 0;
+    while (pos < list.size()) {
+        size_t bracket = list.find('[', pos);
+        size_t comma = list.find(',', pos);
+        if (bracket == std::string::npos || (comma != std::string::npos && comma < bracket)) {
+            size_t end = comma == std::string::npos ? list.size() : comma;
+            if (end > pos) out.push_back(list.substr(pos, end - pos));
+            pos = end + 1;
+            continue;
+        }
+
+        std::string prefix = list.substr(pos, bracket - pos);
+        size_t close = list.find(']', bracket);
+        if (close == std::string::npos) break;
+
+        std::istringstream ranges(list.substr(bracket + 1, close - bracket - 1));
+        for (std::string r; std::getline(ranges, r, ','); ) {
+            size_t dash = r.find('-');
+            std::string lo = r.substr(0, dash);
+            std::string hi = dash == std::string::npos ? lo : r.substr(dash + 1);
+            int width = (int)lo.size();
+            for (int i = std::stoi(lo); i <= std::stoi(hi); ++i) {
+                char buf[32];
+                std::snprintf(buf, sizeof(buf), "%0*d", width, i);
+                out.push_back(prefix + buf);
+            }
+        }
+        pos = close + 2;
+    }
+    return out;
+}
+
+// Inverse of expandHostlist for node indexes, e.g. {0,1,2,6} -> "fake[0001-0003,0007]".
+std::string compressHostlist(std::vector<int> nodes) {
+    if (nodes.empty()) return "";
+    std::sort(nodes.begin(), nodes.end());
+    nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+    if (nodes.size() == 1) return nodeName(nodes[0]);
+
+    std::string out = "fake[";
+    for (size_t i = 0; i < nodes.size(); ) {
+        size_t j = i;
+        while (j + 1 < nodes.size() && nodes[j + 1] == nodes[j] + 1) ++j;
+        if (i) out += ",";
+        out += nodeName(nodes[i]).substr(4);
+        if (j > i) out += "-" + nodeName(nodes[j]).substr(4);
+        i = j + 1;
+    }
+    return out + "]";
+}
+
+std::string rangeList(const std::vector<int>& ids) {
+    std::string out;
+    for (size_t i = 0; i < ids.size(); ) {
+        size_t j = i;
+        while (j + 1 < ids.size() && ids[j + 1] == ids[j] + 1) ++j;
+        if (!out.empty()) out += ",";
+        out += std::to_string(ids[i]);
+        if (j > i) out += "-" + std::to_string(ids[j]);
+        i = j + 1;
+    }
+    return out;
+}
+
+std::string duration(long seconds) {
+    char buf[32];
+    long d = seconds / 86400, h = seconds / 3600 % 24, m = seconds / 60 % 60, s = seconds % 60;
+    if (d) std::snprintf(buf, sizeof(buf), "%ld-%02ld:%02ld:%02ld", d, h, m, s);
+    else std::snprintf(buf, sizeof(buf), "%02ld:%02ld:%02ld", h, m, s);
+    return buf;
+}
+
+std::string timestamp(std::time_t t) {
+    char buf[32];
+    std::strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S", std::localtime(&t));
+    return buf;
+}
+
+struct Slice {
+    int node;
+    int core_start;
+    int cores;
+    int gpu_start;
+    int gpus;
+};
+
+struct Job {
+    std::string id;
+    std::string array_id;
+    int task = -1;
+    std::string name;
+    std::string user;
+    std::string state;
+    std::string reason = "None";
+    std::string partition;
+    int nodes = 1;
+    int cores_per_node = 1;
+    int gpus_per_node = 0;
+    long elapsed = 0;
+    long limit = 86400;
+    std::vector<Slice> slices;
+
+    int cpus() const { return nodes * cores_per_node; }
+    std::vector<int> nodeIndexes() const {
+        std::vector<int> out;
+        for (const auto& s : slices) out.push_back(s.node);
+        return out;
+    }
+};
+
+struct Cluster {
+    Config cfg;
+    std::vector<Job> jobs;
+    std::vector<int> used_cores;
+    std::vector<int> used_gpus;
+
+    bool place(Job& job, int& cursor) {
+        std::vector<int> picked;
+        for (int tried = 0; tried < cfg.nodes && (int)picked.size() < job.nodes; ++tried) {
+            int n = (cursor + tried) % cfg.nodes;
+            if (used_cores[n] + job.cores_per_node <= cfg.cores && used_gpus[n] + job.gpus_per_node <= cfg.gpus) {
+                picked.push_back(n);
+            }
+        }
+        if ((int)picked.size() < job.nodes) return false;
+
+        for (int n : picked) {
+            job.slices.push_back({n, used_cores[n], job.cores_per_node, used_gpus[n], job.gpus_per_node});
+            used_cores[n] += job.cores_per_node;
+            used_gpus[n] += job.gpus_per_node;
+        }
+        cursor = (picked.back() + 1) % cfg.nodes;
+        return true;
+    }
+
+    explicit Cluster(const Config& c) : cfg(c), used_cores(c.nodes, 0), used_gpus(c.nodes, 0) {
+        Rng rng(cfg.seed);
+        static const char* names[] = {"train", "preprocess", "sim", "analysis", "bench", "mpi_run"};
+        static const char* others[] = {"alice", "bob", "carol", "dave"};
+        static const char* partitions[] = {"short", "long", "gpu"};
+        static const char* reasons[] = {"Resources", "Priority", "Dependency", "QOSMaxJobsPerUserLimit"};
+
+        int cursor = 0;
+        int total = cfg.jobs + cfg.other_jobs;
+        for (int i = 0; i < total; ++i) {
+            Job job;
+            job.id = std::to_string(100000 + i);
+            job.user = i < cfg.jobs ? cfg.user : others[i % 4];
+            job.name = std::string(names[rng.range(0, 5)]) + "_" + std::to_string(i);
+            job.partition = partitions[rng.range(0, 2)];
+            job.nodes = std::min(cfg.nodes, 1 << rng.range(0, 3));
+            job.cores_per_node = std::max(1, cfg.cores >> rng.range(0, 3));
+            job.gpus_per_node = job.partition == std::string("gpu") ? std::min(cfg.gpus, rng.range(1, 4)) : 0;
+            job.limit = 3600L * rng.range(1, 48);
+
+            if (rng.range(0, 3) > 0 && place(job, cursor)) {
+                job.state = "RUNNING";
+                job.elapsed = rng.range(60, (int)job.limit - 1);
+            } else {
+                job.state = "PENDING";
+                job.reason = reasons[rng.range(0, 3)];
+            }
+            jobs.push_back(job);
+        }
+
+        for (int t = 0; t < cfg.array_tasks; ++t) {
+            Job job;
+            job.array_id = "500000";
+            job.task = t;
+            job.id = "500000_" + std::to_string(t);
+            job.user = cfg.user;
+            job.name = "sweep";
+            job.partition = "short";
+            job.cores_per_node = std::max(1, cfg.cores / 32);
+            job.limit = 7200;
+            if (t < 8 && place(job, cursor)) {
+                job.state = "RUNNING";
+                job.elapsed = 30 + 17 * t;
+            } else {
+                job.state = "PENDING";
+                job.reason = t < 8 ? "Resources" : "JobArrayTaskLimit";
+            }
+            jobs.push_back(job);
+        }
+    }
+
+    const Job* find(const std::string& id) const {
+        for (const auto& j : jobs) if (j.id == id) return &j;
+        return nullptr;
+    }
+
+    std::vector<const Job*> jobsOnNode(int node) const {
+        std::vector<const Job*> out;
+        for (const auto& j : jobs) {
+            for (const auto& s : j.slices) if (s.node == node) { out.push_back(&j); break; }
+        }
+        return out;
+    }
+
+    std::string nodeState(int n) const {
+        if (n % 97 == 96) return "DOWN*";
+        if (n % 53 == 52) return "IDLE+DRAIN";
+        if (used_cores[n] == 0 && used_gpus[n] == 0) return "IDLE";
+        if (used_cores[n] >= cfg.cores) return "ALLOCATED";
+        return "MIXED";
+    }
+
+    std::string nodePartitions(int n) const {
+        std::string out = "short,long";
+        if (cfg.gpus > 0 && n % 2 == 0) out += ",gpu";
+        return out;
+    }
+};
+
+// Splits "%i %j" style format strings into literal text and fields.
+template <typename Field>
+std::string format(const std::string& fmt, Field field) {
+    std::string out;
+    for (size_t i = 0; i < fmt.size(); ++i) {
+        if (fmt[i] != '%' || i + 1 >= fmt.size()) {
+            out += fmt[i];
+            continue;
+        }
+        size_t j = i + 1;
+        bool right = false;
+        if (fmt[j] == '.') { right = true; ++j; }
+        int width = 0;
+        while (j < fmt.size() && std::isdigit((unsigned char)fmt[j])) width = width * 10 + (fmt[j++] - '0');
+        if (j >= fmt.size()) break;
+
+        std::string value = field(fmt[j]);
+        if ((int)value.size() < width) {
+            std::string pad(width - value.size(), ' ');
+            value = right ? pad + value : value + pad;
+        }
+        out += value;
+        i = j;
+    }
+    return out;
+}
+
+struct Args {
+    std::vector<std::string> positional;
+    std::map<std::string, std::string> options;
+    std::set<std::string> flags;
+
+    Args(int argc, char** argv, const std::set<std::string>& with_value) {
+        for (int i = 1; i < argc; ++i) {
+            std::string a = argv[i];
+            size_t eq = a.find('=');
+            if (a.size() > 2 && a[0] == '-' && a[1] == '-' && eq != std::string::npos) {
+                options[a.substr(0, eq)] = a.substr(eq + 1);
+            } else if (with_value.count(a) && i + 1 < argc) {
+                options[a] = argv[++i];
+            } else if (a[0] == '-') {
+                flags.insert(a);
+            } else {
+                positional.push_back(a);
+            }
+        }
+    }
+
+    std::string get(const std::string& a, const std::string& b = "") const {
+        auto it = options.find(a);
+        if (it != options.end()) return it->second;
+        it = options.find(b);
+        return it != options.end() ? it->second : "";
+    }
+    bool has(const std::string& f) const { return flags.count(f) > 0; }
+};
+
+std::set<std::string> splitSet(const std::string& s) {
+    std::set<std::string> out;
+    std::istringstream iss(s);
+    for (std::string item; std::getline(iss, item, ','); ) if (!item.empty()) out.insert(item);
+    return out;
+}
+
+int squeue(const Cluster& c, const Args& args) {
+    std::string fmt = args.get("-o", "--format");
+    if (fmt.empty()) fmt = "%.18i %.9P %.8j %.8u %.2t %.10M %.6D %R";
+
+    std::string user = args.get("-u", "--user");
+    auto ids = splitSet(args.get("-j", "--jobs"));
+    std::set<int> on_nodes;
+    for (const auto& n : expandHostlist(args.get("-w", "--nodelist"))) on_nodes.insert(nodeIndex(n));
+    bool expand_arrays = args.has("-r") || args.has("--array");
+
+    std::vector<const Job*> selected;
+    for (const auto& j : c.jobs) {
+        if (!user.empty() && j.user != user) continue;
+        if (!ids.empty() && !ids.count(j.id) && !ids.count(j.array_id)) continue;
+        if (!on_nodes.empty()) {
+            bool hit = false;
+            for (const auto& s : j.slices) hit |= on_nodes.count(s.node) > 0;
+            if (!hit) continue;
+        }
+        selected.push_back(&j);
+    }
+
+    // pending array tasks collapse into one "500000_[8-99]" record unless -r
+    std::map<std::string, std::vector<int>> pending_tasks;
+    std::map<std::string, const Job*> first_pending;
+    if (!expand_arrays) {
+        std::vector<const Job*> kept;
+        for (const Job* j : selected) {
+            if (!j->array_id.empty() && j->state == "PENDING") {
+                pending_tasks[j->array_id].push_back(j->task);
+                if (!first_pending.count(j->array_id)) first_pending[j->array_id] = j;
+                continue;
+            }
+            kept.push_back(j);
+        }
+        selected = kept;
+    }
+
+    auto print = [&](const Job& j, const std::string& id, const std::string& task) {
+        std::cout << format(fmt, [&](char f) -> std::string {
+            switch (f) {
+                case 'i': return id;
+                case 'A': return j.array_id.empty() ? j.id : j.array_id;
+                case 'F': return j.array_id.empty() ? j.id : j.array_id;
+                case 'K': return task.empty() ? "N/A" : task;
+                case 'j': return j.name;
+                case 'u': return j.user;
+                case 'T': return j.state;
+                case 't': return j.state == "RUNNING" ? "R" : "PD";
+                case 'P': return j.partition;
+                case 'D': return std::to_string(j.nodes);
+                case 'C': return std::to_string(j.cpus());
+                case 'M': return duration(j.elapsed);
+                case 'l': return duration(j.limit);
+                case 'r': return j.reason;
+                case 'N': return compressHostlist(j.nodeIndexes());
+                case 'R': return j.state == "RUNNING" ? compressHostlist(j.nodeIndexes()) : "(" + j.reason + ")";
+                case 'b': return j.gpus_per_node ? "gres/gpu:" + std::to_string(j.gpus_per_node) : "N/A";
+                default: return "";
+            }
+        }) << "\n";
+    };
+
+    if (!args.has("-h") && !args.has("--noheader")) std::cout << "JOBID NAME\n";
+    for (const Job* j : selected) print(*j, j->id, j->task >= 0 ? std::to_string(j->task) : "");
+    for (const auto& [array_id, tasks] : pending_tasks) {
+        std::string range = rangeList(tasks);
+        print(*first_pending[array_id], array_id + "_[" + range + "]", range);
+    }
+    return 0;
+}
+
+// `tasks` overrides ArrayTaskId, for the record standing for pending tasks.
+void printJob(const Cluster& c, const Job& j, bool detailed, bool one_line, const std::string& tasks = "") {
+    std::time_t now = std::time(nullptr);
+    std::ostringstream out;
+    out << "JobId=" << (tasks.empty() ? j.id : j.array_id) << " JobName=" << j.name << "\n";
+    if (!j.array_id.empty()) {
+        out << "   ArrayJobId=" << j.array_id << " ArrayTaskId=" << (tasks.empty() ? std::to_string(j.task) : tasks) << "\n";
+    }
+    out
+              << "   UserId=" << j.user << "(1000) GroupId=" << j.user << "(1000) MCS_label=N/A\n"
+              << "   Priority=10000 Nice=0 Account=proj QOS=normal\n"
+              << "   JobState=" << j.state << " Reason=" << j.reason << " Dependency=(null)\n"
+              << "   RunTime=" << duration(j.elapsed) << " TimeLimit=" << duration(j.limit) << " TimeMin=N/A\n"
+              << "   SubmitTime=" << timestamp(now - j.elapsed - 600) << " EligibleTime=" << timestamp(now - j.elapsed - 600) << "\n"
+              << "   Partition=" << j.partition << " AllocNode:Sid=login1:4242\n"
+              << "   NodeList=" << (j.slices.empty() ? "(null)" : compressHostlist(j.nodeIndexes())) << "\n"
+              << "   NumNodes=" << j.nodes << " NumCPUs=" << j.cpus() << " NumTasks=" << j.nodes
+              << " CPUs/Task=" << j.cores_per_node << " ReqB:S:C:T=0:0:*:*\n";
+    if (!j.slices.empty()) out << "   BatchHost=" << nodeName(j.slices.front().node) << "\n";
+
+    if (detailed) {
+        // like scontrol, nodes with the same CPU_IDs and GRES share a line
+        for (size_t i = 0; i < j.slices.size(); ) {
+            const auto& s = j.slices[i];
+            std::vector<int> group;
+            for (; i < j.slices.size(); ++i) {
+                const auto& o = j.slices[i];
+                if (o.core_start != s.core_start || o.cores != s.cores || o.gpus != s.gpus || o.gpu_start != s.gpu_start) break;
+                group.push_back(o.node);
+            }
+            out << "     Nodes=" << compressHostlist(group)
+                      << " CPU_IDs=" << s.core_start << "-" << (s.core_start + s.cores - 1)
+                      << " Mem=" << s.cores * 3900;
+            if (s.gpus) {
+                out << " GRES=gpu:a100:" << s.gpus << "(IDX:" << s.gpu_start;
+                if (s.gpus > 1) out << "-" << (s.gpu_start + s.gpus - 1);
+                out << ")";
+            }
+            out << "\n";
+        }
+    }
+
+    std::string pattern = j.array_id.empty() ? "slurm-%j" : "slurm-%A_%a";
+    out << "   MinCPUsNode=" << j.cores_per_node << " MinMemoryNode=" << j.cores_per_node * 3900 << "M\n"
+              << "   Features=(null) DelayBoot=00:00:00\n"
+              << "   Command=/home/" << c.cfg.user << "/run.sh\n"
+              << "   WorkDir=/home/" << c.cfg.user << "\n"
+              << "   StdErr=/home/" << c.cfg.user << "/" << pattern << ".err\n"
+              << "   StdIn=/dev/null\n"
+              << "   StdOut=/home/" << c.cfg.user << "/" << pattern << ".out\n";
+
+    std::string record = out.str();
+    if (!one_line) {
+        std::cout << record << "\n";
+        return;
+    }
+
+    // -o: one record per line, fields separated by single spaces
+    std::string line;
+    bool space = false;
+    for (char ch : record) {
+        if (ch == '\n' || ch == ' ') {
+            space = !line.empty();
+            continue;
+        }
+        if (space) line += ' ';
+        space = false;
+        line += ch;
+    }
+    std::cout << line << "\n";
+}
+
+void printNode(const Cluster& c, int n, bool one_line) {
+    int sockets = c.cfg.cores >= 2 ? 2 : 1;
+    int load = c.used_cores[n];
+    std::string sep = one_line ? " " : "\n   ";
+    // half the GPUs on each socket, as gres.conf Cores= lines show up
+    std::string gres = "(null)";
+    if (c.cfg.gpus > 0 && sockets == 2 && c.cfg.gpus % 2 == 0) {
+        std::string half = "gpu:a100:" + std::to_string(c.cfg.gpus / 2);
+        gres = half + "(S:0)," + half + "(S:1)";
+    } else if (c.cfg.gpus > 0) {
+        gres = "gpu:a100:" + std::to_string(c.cfg.gpus) + "(S:0-" + std::to_string(sockets - 1) + ")";
+    }
+
+    std::cout << "NodeName=" << nodeName(n) << " Arch=x86_64 CoresPerSocket=" << c.cfg.cores / sockets
+              << sep << "CPUAlloc=" << c.used_cores[n] << " CPUEfctv=" << c.cfg.cores << " CPUTot=" << c.cfg.cores
+              << " CPULoad=" << load * 0.9
+              << sep << "Gres=" << gres
+              << sep << "NodeAddr=" << nodeName(n) << " NodeHostName=" << nodeName(n)
+              << sep << "RealMemory=" << c.cfg.cores * 4000 << " AllocMem=" << c.used_cores[n] * 3900
+              << " FreeMem=" << c.cfg.cores * 4000 - c.used_cores[n] * 3000 << " Sockets=" << sockets << " Boards=1"
+              << sep << "State=" << c.nodeState(n) << " ThreadsPerCore=1 TmpDisk=0 Weight=1"
+              << sep << "Partitions=" << c.nodePartitions(n)
+              << sep << "CfgTRES=cpu=" << c.cfg.cores << ",mem=" << c.cfg.cores * 4000 << "M,gres/gpu=" << c.cfg.gpus
+              << sep << "AllocTRES=cpu=" << c.used_cores[n] << ",gres/gpu=" << c.used_gpus[n]
+              << (one_line ? "\n" : "\n\n");
+}
+
+int scontrol(const Cluster& c, const Args& args) {
+    auto& pos = args.positional;
+    if (pos.size() < 2 || pos[0] != "show") {
+        std::cerr << "scontrol: fakeslurm only implements 'show'\n";
+        return 1;
+    }
+
+    const std::string& entity = pos[1];
+    bool one_line = args.has("-o") || args.has("--oneliner");
+
+    if (entity == "hostnames") {
+        for (const auto& n : expandHostlist(pos.size() > 2 ? pos[2] : "")) std::cout << n << "\n";
+        return 0;
+    }
+
+    if (entity == "node" || entity == "nodes") {
+        if (pos.size() > 2) {
+            for (const auto& name : expandHostlist(pos[2])) {
+                int n = nodeIndex(name);
+                if (n >= 0 && n < c.cfg.nodes) printNode(c, n, one_line);
+            }
+        } else {
+            for (int n = 0; n < c.cfg.nodes; ++n) printNode(c, n, one_line);
+        }
+        return 0;
+    }
+
+    if (entity == "job" || entity == "jobid") {
+        bool detailed = args.has("-dd") || args.has("-d");
+        if (pos.size() < 3) {
+            for (const auto& j : c.jobs) printJob(c, j, detailed, one_line);
+            return 0;
+        }
+
+        // an array job id shows every task; pending ones share one record
+        std::vector<int> pending;
+        const Job* pending_job = nullptr;
+        bool array = false;
+        for (const auto& task : c.jobs) {
+            if (task.array_id != pos[2]) continue;
+            array = true;
+            if (task.state == "PENDING") {
+                pending.push_back(task.task);
+                pending_job = &task;
+            } else {
+                printJob(c, task, detailed, one_line);
+            }
+        }
+        if (pending_job) printJob(c, *pending_job, detailed, one_line, rangeList(pending));
+        if (array) return 0;
+
+        const Job* j = c.find(pos[2]);
+        if (!j) {
+            std::cerr << "slurm_load_jobs error: Invalid job id specified\n";
+            return 1;
+        }
+        printJob(c, *j, detailed, one_line);
+        return 0;
+    }
+
+    std::cerr << "scontrol: unknown entity " << entity << "\n";
+    return 1;
+}
+
+// "Partition:40,CPUsState:30" -> "%40P %30C"; GresUsed has no letter of its
+// own in sinfo, 'U' stands in for it here.
+std::string sinfoLongFormat(const std::string& spec) {
+    static const std::map<std::string, char> letters = {
+        {"partition", 'P'}, {"available", 'a'}, {"time", 'l'}, {"nodes", 'D'},
+        {"statelong", 'T'}, {"statecompact", 't'}, {"cpusstate", 'C'}, {"gres", 'G'},
+        {"gresused", 'U'}, {"nodelist", 'N'}, {"partitionname", 'R'},
+    };
+
+    std::string fmt;
+    std::istringstream iss(spec);
+    for (std::string field; std::getline(iss, field, ','); ) {
+        std::string name = field.substr(0, field.find(':'));
+        std::string width = field.find(':') == std::string::npos ? "20" : field.substr(field.find(':') + 1);
+        std::transform(name.begin(), name.end(), name.begin(), [](unsigned char ch) { return std::tolower(ch); });
+
+        auto it = letters.find(name);
+        if (it == letters.end()) continue;
+        if (!fmt.empty()) fmt += " ";
+        fmt += "%" + width + it->second;
+    }
+    return fmt;
+}
+
+int sinfo(const Cluster& c, const Args& args) {
+    std::string fmt = args.get("-o", "--format");
+    std::string long_fmt = args.get("-O", "--Format");
+    if (!long_fmt.empty()) fmt = sinfoLongFormat(long_fmt);
+    if (fmt.empty()) fmt = "%P %a %l %D %T";
+
+    // sinfo also splits groups whose displayed GRES usage differs
+    bool by_gpus = fmt.find('U') != std::string::npos;
+
+    // one record per (partition, state), like sinfo's default grouping
+    std::map<std::pair<std::string, std::string>, std::vector<int>> groups;
+    for (int n = 0; n < c.cfg.nodes; ++n) {
+        std::string state = c.nodeState(n);
+        std::string lower;
+        if (state.find("DRAIN") != std::string::npos) lower = "drain";
+        else if (state.find("DOWN") != std::string::npos) lower = "down*";
+        else if (state == "IDLE") lower = "idle";
+        else if (state == "ALLOCATED") lower = "allocated";
+        else lower = "mixed";
+
+        std::istringstream parts(c.nodePartitions(n));
+        std::string key = by_gpus ? lower + "|" + std::to_string(c.used_gpus[n]) : lower;
+        for (std::string p; std::getline(parts, p, ','); ) groups[{p, key}].push_back(n);
+    }
+
+    if (!args.has("-h") && !args.has("--noheader")) std::cout << "PARTITION AVAIL TIMELIMIT NODES STATE\n";
+    for (const auto& [key, nodes] : groups) {
+        std::string state = key.second.substr(0, key.second.find('|'));
+        long alloc = 0, total = 0;
+        for (int n : nodes) { alloc += c.used_cores[n]; total += c.cfg.cores; }
+        std::cout << format(fmt, [&](char f) -> std::string {
+            switch (f) {
+                case 'P': return key.first + (key.first == "short" ? "*" : "");
+                case 'R': return key.first;
+                case 'a': return "up";
+                case 'l': return key.first == "short" ? "1-00:00:00" : "7-00:00:00";
+                case 'D': return std::to_string(nodes.size());
+                case 'T': return state;
+                case 't': return state;
+                case 'C': {
+                    // drained and down CPUs count as "other", not idle
+                    bool offline = state == "drain" || state == "down*";
+                    std::string free = std::to_string(total - alloc);
+                    return std::to_string(alloc) + "/" + (offline ? "0/" + free : free + "/0") + "/" + std::to_string(total);
+                }
+                case 'G': return c.cfg.gpus > 0 ? "gpu:a100:" + std::to_string(c.cfg.gpus) + "(S:0-1)" : "(null)";
+                case 'U': {
+                    if (c.cfg.gpus == 0) return "gpu:0";
+                    int used = c.used_gpus[nodes.front()];
+                    std::string idx = used == 0 ? "N/A" : used == 1 ? "0" : "0-" + std::to_string(used - 1);
+                    return "gpu:a100:" + std::to_string(used) + "(IDX:" + idx + ")";
+                }
+                case 'N': return compressHostlist(nodes);
+                default: return "";
+            }
+        }) << "\n";
+    }
+    return 0;
+}
+
+// "now-7days", "2025-01-01T00:00:00" or "2025-01-01" -> epoch seconds
+std::time_t parseTime(const std::string& s, std::time_t now) {
+    if (s.empty()) return 0;
+    if (s.compare(0, 4, "now-") == 0) {
+        long n = std::atol(s.c_str() + 4);
+        if (s.find("day") != std::string::npos) return now - n * 86400;
+        if (s.find("hour") != std::string::npos) return now - n * 3600;
+        return now - n;
+    }
+    if (s == "now") return now;
+    std::tm tm{};
+    tm.tm_isdst = -1;
+    if (std::sscanf(s.c_str(), "%d-%d-%dT%d:%d:%d", &tm.tm_year, &tm.tm_mon, &tm.tm_mday, &tm.tm_hour, &tm.tm_min, &tm.tm_sec) >= 3) {
+        tm.tm_year -= 1900;
+        tm.tm_mon -= 1;
+        return std::mktime(&tm);
+    }
+    return 0;
+}
+
+int sacct(const Cluster& c, const Args& args) {
+    std::time_t now = std::time(nullptr);
+    std::time_t start = parseTime(args.get("-S", "--starttime"), now);
+    // like sacct: since midnight, or since the epoch when jobs are named
+    if (!start && args.get("-j", "--jobs").empty()) start = now - 86400;
+    std::time_t end = parseTime(args.get("-E", "--endtime"), now);
+    if (!end) end = now;
+
+    std::vector<std::string> fields;
+    {
+        std::istringstream iss(args.get("-o", "--format"));
+        for (std::string f; std::getline(iss, f, ','); ) fields.push_back(f.substr(0, f.find('%')));
+    }
+    if (fields.empty()) fields = {"JobID", "JobName", "Partition", "Account", "AllocCPUS", "State", "ExitCode"};
+
+    auto states = splitSet(args.get("-s", "--state"));
+    auto ids = splitSet(args.get("-j", "--jobs"));
+    bool parsable = args.has("-P") || args.has("--parsable2");
+    bool allocations_only = args.has("-X") || args.has("--allocations");
+
+    static const char* finals[] = {"COMPLETED", "COMPLETED", "COMPLETED", "FAILED", "TIMEOUT", "CANCELLED", "OUT_OF_MEMORY"};
+    static const char* shorts[] = {"CD", "CD", "CD", "F", "TO", "CA", "OOM"};
+    static const char* partitions[] = {"short", "long", "gpu"};
+
+    struct Row { std::string id, name, state, partition; std::time_t submit, begin, finish; int cpus, nodes, gpus; long limit; long total_cpu; long max_rss_kb; std::string nodelist; };
+    std::vector<Row> rows;
+
+    // finished jobs spread over the last 90 days, newest last
+    Rng rng(c.cfg.seed * 7919 + 1);
+    for (int i = 0; i < c.cfg.history; ++i) {
+        Row r;
+        r.id = std::to_string(10000 + i);
+        r.name = "hist_" + std::to_string(i % 40);
+        int k = rng.range(0, 6);
+        r.state = finals[k];
+        if (!states.empty() && !states.count(finals[k]) && !states.count(shorts[k])) continue;
+        r.partition = partitions[rng.range(0, 2)];
+        r.nodes = 1 << rng.range(0, 3);
+        r.cpus = r.nodes * (c.cfg.cores >> rng.range(0, 3));
+        r.gpus = r.partition == std::string("gpu") ? r.nodes * std::max(1, c.cfg.gpus / 2) : 0;
+        r.limit = 3600L * rng.range(1, 48);
+        r.submit = now - 90L * 86400 + (long)i * 90L * 86400 / std::max(1, c.cfg.history);
+        r.begin = r.submit + rng.range(0, 6 * 3600);
+        r.finish = std::min(now, r.begin + rng.range(60, (int)r.limit));
+        r.total_cpu = (long)((r.finish - r.begin) * (double)r.cpus * rng.range(5, 100) / 100.0);
+        r.max_rss_kb = (long)rng.range(100, 4000) * 1024 * r.nodes;
+        std::vector<int> nl;
+        for (int n = 0; n < r.nodes; ++n) nl.push_back((i + n) % std::max(1, c.cfg.nodes));
+        r.nodelist = compressHostlist(nl);
+
+        if (!ids.empty() && !ids.count(r.id)) continue;
+        if (r.finish < start || r.submit > end) continue;
+        rows.push_back(r);
+    }
+    for (const auto& j : c.jobs) {
+        if (j.user != c.cfg.user) continue;
+        if (!ids.empty() && !ids.count(j.id) && !ids.count(j.array_id)) continue;
+        if (!states.empty() && !states.count(j.state) && !states.count(j.state == "RUNNING" ? "R" : "PD")) continue;
+        Row r{j.id, j.name, j.state, j.partition, now - j.elapsed - 600, j.state == "RUNNING" ? now - j.elapsed : 0, 0,
+              j.cpus(), j.nodes, j.nodes * j.gpus_per_node, j.limit, (long)(j.elapsed * j.cpus() * 0.6), 2048L * 1024,
+              compressHostlist(j.nodeIndexes())};
+        if (r.submit > end) continue;
+        rows.push_back(r);
+    }
+
+    auto print = [&](const Row& r, const std::string& id, const std::string& name, bool step) {
+        std::string line;
+        long elapsed = r.begin ? (r.finish ? r.finish : now) - r.begin : 0;
+        for (size_t f = 0; f < fields.size(); ++f) {
+            const std::string& k = fields[f];
+            std::string v;
+            if (k == "JobID" || k == "JobIDRaw") v = id;
+            else if (k == "JobName") v = name;
+            else if (k == "State") v = step && r.state == "RUNNING" ? "RUNNING" : r.state;
+            else if (k == "Submit") v = timestamp(r.submit);
+            else if (k == "Start") v = r.begin ? timestamp(r.begin) : "Unknown";
+            else if (k == "End") v = r.finish ? timestamp(r.finish) : "Unknown";
+            else if (k == "Elapsed") v = duration(elapsed);
+            else if (k == "ExitCode") v = r.state == "FAILED" ? "1:0" : "0:0";
+            // max_rss_kb is the job's whole footprint; MaxRSS is one task's
+            else if (k == "MaxRSS") v = !step ? "" : std::to_string(r.max_rss_kb / std::max(1, r.nodes) /
+                                                   (name == "srun" ? std::max(1, (r.cpus + r.nodes - 1) / std::max(1, r.nodes)) : 1)) + "K";
+            else if (k == "CPUTime") v = duration(elapsed * r.cpus);
+            else if (k == "TotalCPU") v = duration(r.total_cpu);
+            else if (k == "NCPUS" || k == "NCPUs" || k == "AllocCPUS") v = std::to_string(r.cpus);
+            else if (k == "NNodes") v = std::to_string(r.nodes);
+            else if (k == "NTasks") v = !step ? "" : name == "srun" ? std::to_string(r.cpus) : name == "extern" ? std::to_string(r.nodes) : "1";
+            else if (k == "Partition") v = step ? "" : r.partition;
+            else if (k == "Account") v = "proj";
+            else if (k == "ReqMem") v = std::to_string(r.cpus * 4000) + "M";
+            else if (k == "Timelimit") v = step ? "" : duration(r.limit);
+            else if (k == "NodeList") v = r.nodelist.empty() ? "None assigned" : r.nodelist;
+            else if (k == "AllocTRES" || k == "ReqTRES") v = "cpu=" + std::to_string(r.cpus) + ",node=" + std::to_string(r.nodes) + (r.gpus ? ",gres/gpu=" + std::to_string(r.gpus) : "");
+            else if (k == "AveDiskRead" || k == "AveDiskWrite") v = step ? std::to_string(r.max_rss_kb / 3) + "K" : "";
+            if (f) line += parsable ? "|" : " ";
+            line += v;
+        }
+        std::cout << line << "\n";
+    };
+
+    for (const auto& r : rows) {
+        print(r, r.id, r.name, false);
+        if (allocations_only || !r.begin) continue;
+        print(r, r.id + ".batch", "batch", true);
+        print(r, r.id + ".extern", "extern", true);
+        print(r, r.id + ".0", "srun", true);
+    }
+    return 0;
+}
+
+int sstat(const Cluster& c, const Args& args) {
+    const Job* j = c.find(args.get("-j", "--jobs"));
+    if (!j || j->state != "RUNNING") {
+        std::cerr << "sstat: error: no steps running for job\n";
+        return 1;
+    }
+
+    std::vector<std::string> fields;
+    std::istringstream iss(args.get("-o", "--format"));
+    for (std::string f; std::getline(iss, f, ','); ) fields.push_back(f);
+
+    // CPU time keeps growing with the wall clock so samplers see a rate
+    long wall = j->elapsed + (long)(std::time(nullptr) % 100000);
+    for (const std::string step : {".batch", ".0"}) {
+        int ntasks = step == ".0" ? j->nodes : 1;
+        double busy = step == ".0" ? 0.1 + (std::hash<std::string>{}(j->id) % 90) / 100.0 : 0.01;
+        long cpu = (long)(wall * busy * j->cores_per_node);
+        std::string line;
+        for (size_t f = 0; f < fields.size(); ++f) {
+            const std::string& k = fields[f];
+            std::string v;
+            if (k == "JobID") v = j->id + step;
+            else if (k == "AveCPU") v = duration(cpu);
+            else if (k == "MaxRSS") v = std::to_string(512 * 1024 * (step == ".0" ? j->cores_per_node : 1)) + "K";
+            else if (k == "TresUsageInAve") v = "cpu=" + duration(cpu) + ",mem=" + std::to_string(400 * j->cores_per_node) + "M";
+            else if (k == "NTasks") v = std::to_string(ntasks);
+            else if (k == "Nodelist") v = step == ".0" ? compressHostlist(j->nodeIndexes()) : compressHostlist({j->nodeIndexes().front()});
+            else if (k == "AveDiskRead" || k == "AveDiskWrite") v = std::to_string(wall * 10) + "K";
+            if (f) line += "|";
+            line += v;
+        }
+        std::cout << line << "\n";
+    }
+    return 0;
+}
+
+int scancel(const Cluster& c, const Args& args) {
+    int rc = 0;
+    for (const auto& id : args.positional) {
+        if (!c.find(id) && c.find(id + "_0") == nullptr) {
+            std::cerr << "scancel: error: Kill job error on job id " << id << ": Invalid job id specified\n";
+            rc = 1;
+        }
+    }
+    return rc;
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::string tool = argv[0];
+    tool = tool.substr(tool.find_last_of('/') + 1);
+
+    Config cfg;
+
+    if (const char* count_file = std::getenv("FAKESLURM_COUNT_FILE")) {
+        std::ofstream out(count_file, std::ios::app);
+        out << tool << "\n";
+    }
+
+    if (cfg.latency_ms > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(cfg.latency_ms));
+    }
+
+    Cluster cluster(cfg);
+
+    if (tool == "squeue") return squeue(cluster, Args(argc, argv, {"-u", "--user", "-o", "--format", "-j", "--jobs", "-w", "--nodelist", "-t", "--states"}));
+    if (tool == "scontrol") return scontrol(cluster, Args(argc, argv, {}));
+    if (tool == "sinfo") return sinfo(cluster, Args(argc, argv, {"-o", "--format", "-O", "--Format", "-p", "--partition"}));
+    if (tool == "sacct") return sacct(cluster, Args(argc, argv, {"-u", "--user", "-o", "--format", "-S", "--starttime", "-E", "--endtime", "-s", "--state", "-j", "--jobs"}));
+    if (tool == "sstat") return sstat(cluster, Args(argc, argv, {"-j", "--jobs", "-o", "--format"}));
+    if (tool == "scancel") return scancel(cluster, Args(argc, argv, {"-u", "--user", "-n", "--name", "-t", "--state"}));
+
+    std::cerr << "fakeslurm: unknown tool '" << tool << "' (link me as squeue, scontrol, sinfo, sacct, sstat or scancel)\n";
+    return 1;
+}
@@ -0,0 +1,53 @@
+#!/bin/sh
+# Scaling run of rsv against the synthetic cluster from fakeslurm.
+#
+#   tools/fakeslurm/loadtest.sh <build-dir> [frames]
+#
+# For every size below, puts <build-dir>/fakeslurm/bin ahead of the real
+# Slurm commands on PATH, renders `frames` headless frames with rsv and
+# prints one CSV row: cluster shape, wall time, subprocesses spawned and
+# frame latency percentiles. Extra FAKESLURM_* variables (e.g.
+# FAKESLURM_LATENCY_MS) are passed through.
+
+set -eu
+
+BUILD_DIR=${1:?usage: loadtest.sh <build-dir> [frames]}
+FRAMES=${2:-100}
+
+BUILD_DIR=$(cd "$BUILD_DIR" && pwd)
+RSV="$BUILD_DIR/rsv"
+FAKE_BIN="$BUILD_DIR/fakeslurm/bin"
+
+[ -x "$RSV" ] || { echo "missing $RSV" >&2; exit 1; }
+[ -x "$FAKE_BIN/squeue" ] || { echo "missing $FAKE_BIN (build the fakeslurm target)" >&2; exit 1; }
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+# nodes:jobs:cores:gpus:array_tasks
+SIZES=${LOADTEST_SIZES:-"16:5:64:0:0 256:50:128:4:0 2000:200:128:4:0 2000:200:256:8:10000"}
+
+echo "nodes,jobs,cores,gpus,array_tasks,frames,wall_s,subprocesses,frame_p50_ms,frame_p99_ms,frame_max_ms"
+
+for size in $SIZES; do
+    IFS=: read -r nodes jobs cores gpus tasks <<EOF
+$size
+EOF
+
+    : > "$WORK/count"
+    start=$(date +%s.%N)
+
+    PATH="$FAKE_BIN:$PATH" \
+    FAKESLURM_NODES=$nodes FAKESLURM_JOBS=$jobs FAKESLURM_CORES=$cores \
+    FAKESLURM_GPUS=$gpus FAKESLURM_ARRAY_TASKS=$tasks \
+    FAKESLURM_COUNT_FILE="$WORK/count" \
+        "$RSV" --headless "$FRAMES" --stats-out "$WORK/stats.tsv" > /dev/null
+
+    end=$(date +%s.%N)
+
+    wall=$(awk "BEGIN { printf \"%.3f\", $end - $start }")
+    spawned=$(wc -l < "$WORK/count" | tr -d ' ')
+    frame=$(awk -F'\t' '$1 == "headless:frame" { print $4 "," $6 "," $7 }' "$WORK/stats.tsv")
+
+    echo "$nodes,$jobs,$cores,$gpus,$tasks,$FRAMES,$wall,$spawned,${frame:-,,}"
+done